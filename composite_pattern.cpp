@@ -9,15 +9,69 @@
    regardless of whether they are composite or leaf nodes.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <string>
 
+class HeadDepartment;
+
+// Headcount, budget (whole currency units) and number of departments of a
+// department or a subtree
+struct Staffing {
+    std::int64_t headcount = 0;
+    std::int64_t budget = 0;
+    std::int64_t departments = 0;
+};
+
 // Component interface
+// Every department keeps its subtree's staffing totals up to date: a change
+// adds its delta to the department and each ancestor, so totals are O(1) to
+// read and O(depth) to update.
 class Department {
 public:
     virtual void showDetails() const = 0;
+    // Sub-departments, as an intrusive sibling list; leaves have none
+    virtual std::size_t childCount() const { return 0; }
+    virtual const Department* firstChild() const { return nullptr; }
+    const Department* nextSibling() const { return next; }
     virtual ~Department() {}
+
+    void setStaffing(std::int64_t headcount, std::int64_t budget) {
+        propagate(headcount - own.headcount, budget - own.budget, 0);
+        own.headcount = headcount;
+        own.budget = budget;
+    }
+
+    const Staffing& ownStaffing() const { return own; }
+    const Staffing& totals() const { return total; }
+    HeadDepartment* parent() const { return up; }
+
+protected:
+    void propagate(std::int64_t headcount, std::int64_t budget, std::int64_t departments);
+
+    HeadDepartment* up = nullptr;
+    Department* prev = nullptr;  // Siblings under the same parent
+    Department* next = nullptr;
+
+private:
+    friend class HeadDepartment;
+
+    Staffing own{0, 0, 1};
+    Staffing total{0, 0, 1};
 };
 
 // Leaf - HR Department
@@ -37,32 +91,374 @@ public:
 };
 
 // Composite - Can hold sub-departments
+// Children form an intrusive doubly linked list, so adding and removing a
+// sub-department is O(1) and every department knows its parent.
 class HeadDepartment : public Department {
 private:
-    std::vector<Department*> departments;
+    Department* first = nullptr;
+    Department* last = nullptr;
+    std::size_t count = 0;
 
 public:
+    // Moves dept here from wherever it is attached; a department can't go under its own subtree
     void add(Department* dept) {
-        departments.push_back(dept);
+        for (const Department* above = this; above; above = above->up) {
+            if (above == dept) {
+                throw std::invalid_argument("Cannot add a department under its own subtree");
+            }
+        }
+        if (dept->up) {
+            dept->up->remove(dept);
+        }
+        dept->up = this;
+        dept->prev = last;
+        dept->next = nullptr;
+        (last ? last->next : first) = dept;
+        last = dept;
+        ++count;
+        propagate(dept->totals().headcount, dept->totals().budget, dept->totals().departments);
     }
 
     void remove(Department* dept) {
-        departments.erase(std::remove(departments.begin(), departments.end(), dept), departments.end());
+        if (dept->up != this) {
+            return;
+        }
+        (dept->prev ? dept->prev->next : first) = dept->next;
+        (dept->next ? dept->next->prev : last) = dept->prev;
+        dept->up = nullptr;
+        dept->prev = dept->next = nullptr;
+        --count;
+        propagate(-dept->totals().headcount, -dept->totals().budget, -dept->totals().departments);
     }
 
     void showDetails() const override {
-        for (const auto& dept : departments) {
+        for (const Department* dept = first; dept; dept = dept->nextSibling()) {
             dept->showDetails();
         }
     }
 
+    std::size_t childCount() const override {
+        return count;
+    }
+
+    const Department* firstChild() const override {
+        return first;
+    }
+
     ~HeadDepartment() {
-        for (auto dept : departments) {
+        for (Department* dept = first; dept;) {
+            Department* following = dept->next;
             delete dept;
+            dept = following;
         }
     }
 };
 
+inline void Department::propagate(std::int64_t headcount, std::int64_t budget, std::int64_t departments) {
+    for (Department* dept = this; dept; dept = dept->up) {
+        dept->total.headcount += headcount;
+        dept->total.budget += budget;
+        dept->total.departments += departments;
+    }
+}
+
+// Read-only snapshot of a department tree in preorder arrays. Every subtree
+// occupies the contiguous range [i, i + subtreeSize[i]), so whole-tree and
+// subtree passes are linear scans with no recursion or pointer chasing. The
+// same ranges are an Euler-tour interval labeling that answers "is X under Y"
+// in O(1), and binary-lifting tables answer lowest-common-ancestor queries in
+// O(log depth). Rebuild it after the composite changes.
+class FlatOrgTree {
+public:
+    static constexpr std::uint32_t kNoParent = UINT32_MAX;
+
+    explicit FlatOrgTree(const Department& root) {
+        std::vector<std::pair<const Department*, std::uint32_t>> stack(1, {&root, kNoParent});
+        while (!stack.empty()) {
+            const Department* dept = stack.back().first;
+            std::uint32_t up = stack.back().second;
+            stack.pop_back();
+            std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+            nodes.push_back(dept);
+            parent.push_back(up);
+            depth.push_back(up == kNoParent ? 0 : depth[up] + 1);
+            // Reverse the pushed children so they come out in their original order
+            std::size_t mark = stack.size();
+            for (const Department* child = dept->firstChild(); child; child = child->nextSibling()) {
+                stack.push_back({child, index});
+            }
+            std::reverse(stack.begin() + mark, stack.end());
+        }
+        subtreeSize.assign(nodes.size(), 1);
+        for (std::size_t i = nodes.size(); i-- > 1;) {
+            subtreeSize[parent[i]] += subtreeSize[i];
+        }
+
+        indexOf.reserve(nodes.size());
+        for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+            indexOf.emplace(nodes[i], i);
+        }
+
+        // jumps[k][i] is the 2^k-th ancestor of i, clamped at the root
+        jumps.emplace_back(parent);
+        jumps[0][0] = 0;
+        std::uint32_t maxDepth = *std::max_element(depth.begin(), depth.end());
+        for (std::size_t k = 1; (std::uint32_t(1) << k) <= maxDepth; ++k) {
+            const std::vector<std::uint32_t>& half = jumps[k - 1];
+            std::vector<std::uint32_t> full(nodes.size());
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                full[i] = half[half[i]];
+            }
+            jumps.push_back(std::move(full));
+        }
+    }
+
+    // Preorder index of a department in this snapshot
+    std::uint32_t index(const Department* dept) const {
+        return indexOf.at(dept);
+    }
+
+    // True if b is a (or is the same) department within a's subtree
+    bool isAncestor(std::uint32_t a, std::uint32_t b) const {
+        return a <= b && b < a + subtreeSize[a];
+    }
+
+    bool isAncestor(const Department* a, const Department* b) const {
+        return isAncestor(index(a), index(b));
+    }
+
+    // Lowest department that has both a and b in its subtree
+    std::uint32_t lowestCommonAncestor(std::uint32_t a, std::uint32_t b) const {
+        if (isAncestor(a, b)) {
+            return a;
+        }
+        if (isAncestor(b, a)) {
+            return b;
+        }
+        for (std::size_t k = jumps.size(); k-- > 0;) {
+            if (!isAncestor(jumps[k][a], b)) {
+                a = jumps[k][a];
+            }
+        }
+        return parent[a];
+    }
+
+    const Department* lowestCommonAncestor(const Department* a, const Department* b) const {
+        return nodes[lowestCommonAncestor(index(a), index(b))];
+    }
+
+    std::size_t size() const {
+        return nodes.size();
+    }
+
+    // Calls visit(index) for every department in the subtree rooted at index, in preorder
+    template <typename Visit>
+    void forEachInSubtree(std::uint32_t index, Visit visit) const {
+        for (std::uint32_t i = index, end = index + subtreeSize[index]; i < end; ++i) {
+            visit(i);
+        }
+    }
+
+    // Same output as showDetails() on the original composite
+    void showDetails(std::uint32_t index = 0) const {
+        forEachInSubtree(index, [this](std::uint32_t i) {
+            if (subtreeSize[i] == 1) {
+                nodes[i]->showDetails();
+            }
+        });
+    }
+
+    std::vector<const Department*> nodes;
+    std::vector<std::uint32_t> parent;       // kNoParent for the root
+    std::vector<std::uint32_t> subtreeSize;  // Including the node itself
+    std::vector<std::uint32_t> depth;
+
+private:
+    std::unordered_map<const Department*, std::uint32_t> indexOf;
+    std::vector<std::vector<std::uint32_t>> jumps;
+};
+
+// Thread pool with one task deque per worker. Workers push and pop their own
+// deque at the back (newest first, cache-warm) and steal the oldest, usually
+// largest, task from the front of another worker's deque when theirs is empty.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads = std::max(1u, std::thread::hardware_concurrency())) {
+        for (unsigned i = 0; i < threads; ++i) {
+            queues.emplace_back(new Queue);
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back(&WorkStealingPool::work, this, i);
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            stopping = true;
+        }
+        idle.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::size_t size() const {
+        return workers.size();
+    }
+
+    // Queues a task on the calling worker's deque, or spreads external submissions
+    void submit(std::function<void()> task) {
+        std::size_t index = currentPool == this ? currentIndex : nextExternal++ % queues.size();
+        queued++;  // Before the push, so runOne's decrement can never come first
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            // A worker between its predicate check and its wait holds idleMutex, so the wakeup can't be lost
+            std::lock_guard<std::mutex> lock(idleMutex);
+        }
+        idle.notify_one();
+    }
+
+    // Runs one queued task if there is any; lets waiting threads help out
+    bool runOne() {
+        std::size_t home = currentPool == this ? currentIndex : 0;
+        std::function<void()> task;
+        for (std::size_t k = 0; k < queues.size() && !task; ++k) {
+            Queue& queue = *queues[(home + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                if (k == 0 && currentPool == this) {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                } else {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+            }
+        }
+        if (!task) {
+            return false;
+        }
+        queued--;
+        task();
+        return true;
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void work(std::size_t index) {
+        currentPool = this;
+        currentIndex = index;
+        while (!stopping) {
+            if (!runOne()) {
+                std::unique_lock<std::mutex> lock(idleMutex);
+                idle.wait(lock, [this] { return stopping || queued > 0; });
+            }
+        }
+    }
+
+    static thread_local WorkStealingPool* currentPool;
+    static thread_local std::size_t currentIndex;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> queued{0};
+    std::atomic<std::size_t> nextExternal{0};
+    std::atomic<bool> stopping{false};
+    std::mutex idleMutex;
+    std::condition_variable idle;
+};
+
+thread_local WorkStealingPool* WorkStealingPool::currentPool = nullptr;
+thread_local std::size_t WorkStealingPool::currentIndex = 0;
+
+// Tasks that can be waited for together. wait() runs queued tasks instead of
+// blocking, so tasks may spawn and wait on their own subtasks.
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool(pool) {}
+
+    ~TaskGroup() {
+        wait();
+    }
+
+    template <typename Task>
+    void run(Task task) {
+        pending++;
+        pool.submit([this, task] {
+            task();
+            pending--;
+        });
+    }
+
+    void wait() {
+        while (pending > 0) {
+            if (!pool.runOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    WorkStealingPool& pool;
+    std::atomic<std::size_t> pending{0};
+};
+
+// Visits every department under root exactly once, in no particular order and
+// from several threads at once. Subtrees larger than grain departments (per the
+// maintained totals) become their own tasks; smaller sibling subtrees are
+// batched into tasks of about grain departments that are walked sequentially.
+template <typename Visit>
+void visitParallel(const Department& root, Visit visit, WorkStealingPool& pool, std::int64_t grain = 4096) {
+    TaskGroup group(pool);
+    std::function<void(const Department&)> split = [&](const Department& dept) {
+        visit(dept);
+        std::vector<const Department*> batch;
+        std::int64_t batchSize = 0;
+        auto flush = [&] {
+            group.run([&visit, batch] {
+                std::vector<const Department*> stack(batch);
+                while (!stack.empty()) {
+                    const Department* next = stack.back();
+                    stack.pop_back();
+                    visit(*next);
+                    for (const Department* child = next->firstChild(); child; child = child->nextSibling()) {
+                        stack.push_back(child);
+                    }
+                }
+            });
+            batch.clear();
+            batchSize = 0;
+        };
+        for (const Department* child = dept.firstChild(); child; child = child->nextSibling()) {
+            if (child->totals().departments > grain) {
+                group.run([&split, child] { split(*child); });
+            } else {
+                batch.push_back(child);
+                batchSize += child->totals().departments;
+                if (batchSize >= grain) {
+                    flush();
+                }
+            }
+        }
+        if (!batch.empty()) {
+            flush();
+        }
+    };
+    split(root);
+    group.wait();
+}
+
 // Client Code
 int main() {
     // Create leaf departments
@@ -77,8 +473,158 @@ int main() {
     std::cout << "Company Departments:\n";
     headOffice->showDetails();
 
+    // The same tree flattened into preorder arrays
+    std::cout << "Flattened:\n";
+    FlatOrgTree(*headOffice).showDetails();
+
     // Clean up
     delete headOffice;
 
+    // A large organisation: nested head departments over HR and Finance leaves
+    std::mt19937 rng(7);
+    std::vector<HeadDepartment*> heads(1, new HeadDepartment());
+    for (std::size_t created = 1; created < 500000; ++created) {
+        HeadDepartment* parent = heads[rng() % heads.size()];
+        if (rng() % 4 == 0) {
+            heads.push_back(new HeadDepartment());
+            parent->add(heads.back());
+        } else if (rng() % 2) {
+            parent->add(new HRDepartment());
+        } else {
+            parent->add(new FinanceDepartment());
+        }
+    }
+    HeadDepartment* company = heads[0];
+
+    auto begin = std::chrono::steady_clock::now();
+    std::size_t leaves = 0;
+    std::vector<const Department*> pending(1, company);
+    while (!pending.empty()) {
+        const Department* dept = pending.back();
+        pending.pop_back();
+        leaves += dept->childCount() == 0;
+        for (const Department* child = dept->firstChild(); child; child = child->nextSibling()) {
+            pending.push_back(child);
+        }
+    }
+    double walkMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    FlatOrgTree flat(*company);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    begin = std::chrono::steady_clock::now();
+    std::size_t flatLeaves = 0, deepest = 0;
+    flat.forEachInSubtree(0, [&](std::uint32_t i) {
+        flatLeaves += flat.subtreeSize[i] == 1;
+        deepest = std::max<std::size_t>(deepest, flat.depth[i]);
+    });
+    double scanMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << flat.size() << " departments: pointer walk " << walkMs << " ms, flat build " << buildMs
+              << " ms, flat scan " << scanMs << " ms (" << leaves << "/" << flatLeaves << " without sub-departments, depth "
+              << deepest << ")" << std::endl;
+
+    // Staffing rollups: deltas flow up to the ancestors on every change
+    std::vector<Department*> all(flat.nodes.size());
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        all[i] = const_cast<Department*>(flat.nodes[i]);
+    }
+    begin = std::chrono::steady_clock::now();
+    const int kUpdates = 1000000;
+    for (int u = 0; u < kUpdates; ++u) {
+        all[rng() % all.size()]->setStaffing(rng() % 50, (rng() % 50) * 100000);
+    }
+    double updateNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    // A reorg moves a whole division, with its totals, under a department outside it
+    HeadDepartment* moved = heads[1];
+    HeadDepartment* target = heads.back();
+    for (const Department* dept = target; dept; dept = dept->parent()) {
+        if (dept == moved) {
+            target = company;
+        }
+    }
+    moved->parent()->remove(moved);
+    target->add(moved);
+    Staffing recount;
+    for (const Department* dept : flat.nodes) {
+        recount.headcount += dept->ownStaffing().headcount;
+        recount.budget += dept->ownStaffing().budget;
+    }
+    std::cout << "Company headcount " << company->totals().headcount << " (recount " << recount.headcount << "), budget $"
+              << company->totals().budget << " (recount $" << recount.budget << "); " << updateNs / kUpdates
+              << " ns per update" << std::endl;
+
+    // Whole-tree pass (e.g. access recomputation), sequential and in parallel
+    auto audit = [](const Department& dept) {
+        std::uint64_t h = reinterpret_cast<std::uintptr_t>(&dept);
+        for (int round = 0; round < 200; ++round) {
+            h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ULL;
+        }
+        return (h & 1023) == 0;  // Roughly one department in a thousand gets flagged
+    };
+    begin = std::chrono::steady_clock::now();
+    std::size_t flagged = 0;
+    for (const Department* dept : flat.nodes) {
+        flagged += audit(*dept);
+    }
+    double sequentialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    WorkStealingPool pool;
+    std::atomic<std::size_t> parallelFlagged(0);
+    begin = std::chrono::steady_clock::now();
+    visitParallel(*company, [&](const Department& dept) {
+        if (audit(dept)) {
+            parallelFlagged++;
+        }
+    }, pool);
+    double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Audit flagged " << flagged << " departments in " << sequentialMs << " ms; parallel on " << pool.size()
+              << " threads flagged " << parallelFlagged << " in " << parallelMs << " ms"
+              << (pool.size() == 1 ? " (single core, speedup not measured)" : "") << std::endl;
+
+    // Reorg tooling: reporting-line checks and lowest common managers
+    FlatOrgTree org(*company);
+    std::vector<std::uint32_t> picks(1000000);
+    for (std::uint32_t& pick : picks) {
+        pick = static_cast<std::uint32_t>(rng() % org.size());
+    }
+    begin = std::chrono::steady_clock::now();
+    std::size_t under = 0, belowTop = 0;
+    for (std::size_t q = 0; q + 1 < picks.size(); q += 2) {
+        under += org.isAncestor(picks[q], picks[q + 1]);
+        belowTop += org.lowestCommonAncestor(picks[q], picks[q + 1]) != 0;
+    }
+    double queryNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    std::size_t mismatches = 0;  // Cross-check against walking parent links
+    for (std::size_t q = 0; q + 1 < 2000; q += 2) {
+        const Department* x = org.nodes[picks[q]];
+        const Department* y = org.nodes[picks[q + 1]];
+        std::unordered_set<const Department*> aboveX;
+        for (const Department* dept = x; dept; dept = dept->parent()) {
+            aboveX.insert(dept);
+        }
+        const Department* common = y;
+        while (!aboveX.count(common)) {
+            common = common->parent();
+        }
+        mismatches += common != org.lowestCommonAncestor(x, y);
+    }
+    std::cout << under << " ancestor hits and " << belowTop << " pairs sharing a head below the top, "
+              << queryNs / (picks.size() / 2) << " ns per pair; " << mismatches << " LCA mismatches against parent links"
+              << std::endl;
+
+    // Detaching a department is O(1) regardless of how many siblings it has
+    begin = std::chrono::steady_clock::now();
+    for (std::size_t i = heads.size() / 2; i < heads.size(); ++i) {
+        if (heads[i]->parent()) {
+            heads[i]->parent()->remove(heads[i]);
+            company->add(heads[i]);
+        }
+    }
+    double moveUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Moved " << heads.size() - heads.size() / 2 << " divisions to the top in " << moveUs << " us; company still has "
+              << company->totals().departments << " departments" << std::endl;
+
+    delete company;
+
     return 0;
 }
@@ -7,84 +7,1214 @@
    The Factory Method Pattern helps decouple the creation of shipping methods from the logic that uses them, allowing new types of shipping methods to be added without changing the existing code.
    This makes it easy to extend the system with new shipping methods without modifying existing functionality, promoting open/closed principle.
 */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
-// Base class for all Shipping Methods
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// costs[i] = std::max(weights[i] * distances[i] * rate, minimum), vectorized where
+// the target allows. The product is the second max operand so a NaN passes
+// through, as it does in std::max.
+inline void scaledProducts(const double* weights, const double* distances, double* costs, std::size_t count, double rate,
+                           double minimum) {
+    std::size_t i = 0;
+#if defined(__AVX__)
+    const __m256d factor = _mm256_set1_pd(rate);
+    const __m256d floor = _mm256_set1_pd(minimum);
+    for (; i + 4 <= count; i += 4) {
+        __m256d product = _mm256_mul_pd(_mm256_loadu_pd(weights + i), _mm256_loadu_pd(distances + i));
+        _mm256_storeu_pd(costs + i, _mm256_max_pd(floor, _mm256_mul_pd(product, factor)));
+    }
+#elif defined(__SSE2__)
+    const __m128d factor = _mm_set1_pd(rate);
+    const __m128d floor = _mm_set1_pd(minimum);
+    for (; i + 2 <= count; i += 2) {
+        __m128d product = _mm_mul_pd(_mm_loadu_pd(weights + i), _mm_loadu_pd(distances + i));
+        _mm_storeu_pd(costs + i, _mm_max_pd(floor, _mm_mul_pd(product, factor)));
+    }
+#endif
+    for (; i < count; ++i) {
+        costs[i] = std::max(weights[i] * distances[i] * rate, minimum);
+    }
+}
+
+// Sorted bracket bounds laid out in Eytzinger (BFS) order. The tree is padded to
+// a full 2^levels - 1 nodes so every search runs the same number of steps and
+// the descent compiles to compares and adds with no data-dependent branches.
+class EytzingerIndex {
+public:
+    explicit EytzingerIndex(const std::vector<double>& sortedBounds) {
+        std::size_t size = 1;
+        while (size - 1 < sortedBounds.size()) {
+            size *= 2;
+            ++levels;
+        }
+        tree.assign(size, std::numeric_limits<double>::infinity());
+        bracket.assign(size, sortedBounds.size());
+        std::size_t next = 0;
+        fill(1, sortedBounds, next);
+    }
+
+    // Index of the first bound >= value, i.e. the bracket containing value (bounds are inclusive)
+    std::size_t find(double value) const {
+        std::size_t k = 1;
+        for (unsigned level = 0; level < levels; ++level) {
+            k = 2 * k + (tree[k] < value);
+        }
+        k >>= __builtin_ffsll(static_cast<long long>(~k));  // Back up to the last left turn
+        return bracket[k];
+    }
+
+private:
+    void fill(std::size_t k, const std::vector<double>& sortedBounds, std::size_t& next) {
+        if (k >= tree.size()) {
+            return;
+        }
+        fill(2 * k, sortedBounds, next);
+        if (next < sortedBounds.size()) {
+            tree[k] = sortedBounds[next];
+            bracket[k] = next;
+        }
+        ++next;
+        fill(2 * k + 1, sortedBounds, next);
+    }
+
+    unsigned levels = 0;
+    std::vector<double> tree;          // tree[0] unused
+    std::vector<std::size_t> bracket;  // Sorted position of each tree slot; padding maps past the last bound
+};
+
+// Carrier rate card. Rates are per kg per km for each (weight bracket, distance zone).
+// A bracket covers weights up to and including its bound; values above the last bound
+// fall into one extra open-ended bracket, so rates has (weights + 1) x (zones + 1) entries.
+struct RateCard {
+    std::vector<double> weightBounds;  // kg, ascending
+    std::vector<double> zoneBounds;    // km, ascending
+    std::vector<double> rates;         // Row-major by weight bracket
+    double handlingFee = 0;            // Flat surcharge per shipment
+    double fuelSurcharge = 0;          // Fraction added on top, e.g. 0.12 for 12%
+    double minimumCharge = 0;
+
+    static RateCard flat(double rate) {
+        RateCard card;
+        card.rates = {rate};
+        return card;
+    }
+};
+
+// Rate card compiled for fast quoting: two bracket searches, one table load, and
+// branchless surcharge/minimum arithmetic
+class CompiledRateCard {
+public:
+    explicit CompiledRateCard(const RateCard& card)
+        : weightIndex(card.weightBounds), zoneIndex(card.zoneBounds), zones(card.zoneBounds.size() + 1),
+          rates(card.rates), handlingFee(card.handlingFee), fuelFactor(1.0 + card.fuelSurcharge),
+          minimumCharge(card.minimumCharge) {
+        if (!std::is_sorted(card.weightBounds.begin(), card.weightBounds.end()) ||
+            !std::is_sorted(card.zoneBounds.begin(), card.zoneBounds.end())) {
+            throw std::invalid_argument("Rate card brackets must be ascending");
+        }
+        if (rates.size() != (card.weightBounds.size() + 1) * zones) {
+            throw std::invalid_argument("Rate card needs one rate per weight bracket and zone");
+        }
+    }
+
+    double quote(double weight, double distance) const {
+        double rate = rates[weightIndex.find(weight) * zones + zoneIndex.find(distance)];
+        double charge = (weight * distance * rate + handlingFee) * fuelFactor;
+        return std::max(charge, minimumCharge);
+    }
+
+    // Batch quote; a single-rate card with no surcharges reduces to the SIMD kernel
+    void quote(const double* weights, const double* distances, double* costs, std::size_t count) const {
+        if (rates.size() == 1 && handlingFee == 0 && fuelFactor == 1.0 && minimumCharge <= 0) {
+            scaledProducts(weights, distances, costs, count, rates[0], minimumCharge);
+            return;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            costs[i] = quote(weights[i], distances[i]);
+        }
+    }
+
+private:
+    EytzingerIndex weightIndex;
+    EytzingerIndex zoneIndex;
+    std::size_t zones;
+    std::vector<double> rates;
+    double handlingFee;
+    double fuelFactor;
+    double minimumCharge;
+};
+
+// Base class for all Shipping Methods. Methods are immutable once built, so one
+// instance per method is shared by every caller and thread.
 class ShippingMethod {
 public:
-    virtual void bookShipment() = 0;
-    virtual double calculateShippingCost(double weight, double distance) = 0;
+    virtual const char* name() const = 0;
+    virtual void bookShipment() const = 0;
+    virtual double calculateShippingCost(double weight, double distance) const = 0;
+
+    // Prices `count` shipments of this method at once: one virtual call per batch, not per shipment
+    virtual void calculateShippingCosts(const double* weights, const double* distances, double* costs, std::size_t count) const = 0;
+
     virtual ~ShippingMethod() {}
 };
 
 // Concrete class for AirShipping
 class AirShipping : public ShippingMethod {
 public:
-    void bookShipment() override {
+    explicit AirShipping(const RateCard& card = RateCard::flat(0.5)) : rates(card) {}  // Default: 0.5 per kg per km
+
+    const char* name() const override { return "Air"; }
+
+    void bookShipment() const override {
         std::cout << "Air shipping booked." << std::endl;
     }
 
-    double calculateShippingCost(double weight, double distance) override {
-        return weight * distance * 0.5;  // Example cost calculation for air shipping
+    double calculateShippingCost(double weight, double distance) const override {
+        return rates.quote(weight, distance);
+    }
+
+    void calculateShippingCosts(const double* weights, const double* distances, double* costs, std::size_t count) const override {
+        rates.quote(weights, distances, costs, count);
     }
+
+private:
+    CompiledRateCard rates;
 };
 
 // Concrete class for SeaShipping
 class SeaShipping : public ShippingMethod {
 public:
-    void bookShipment() override {
+    explicit SeaShipping(const RateCard& card = RateCard::flat(0.3)) : rates(card) {}  // Default: 0.3 per kg per km
+
+    const char* name() const override { return "Sea"; }
+
+    void bookShipment() const override {
         std::cout << "Sea shipping booked." << std::endl;
     }
 
-    double calculateShippingCost(double weight, double distance) override {
-        return weight * distance * 0.3;  // Example cost calculation for sea shipping
+    double calculateShippingCost(double weight, double distance) const override {
+        return rates.quote(weight, distance);
+    }
+
+    void calculateShippingCosts(const double* weights, const double* distances, double* costs, std::size_t count) const override {
+        rates.quote(weights, distances, costs, count);
     }
+
+private:
+    CompiledRateCard rates;
 };
 
 // Concrete class for GroundShipping
 class GroundShipping : public ShippingMethod {
 public:
-    void bookShipment() override {
+    explicit GroundShipping(const RateCard& card = RateCard::flat(0.1)) : rates(card) {}  // Default: 0.1 per kg per km
+
+    const char* name() const override { return "Ground"; }
+
+    void bookShipment() const override {
         std::cout << "Ground shipping booked." << std::endl;
     }
 
-    double calculateShippingCost(double weight, double distance) override {
-        return weight * distance * 0.1;  // Example cost calculation for ground shipping
+    double calculateShippingCost(double weight, double distance) const override {
+        return rates.quote(weight, distance);
+    }
+
+    void calculateShippingCosts(const double* weights, const double* distances, double* costs, std::size_t count) const override {
+        rates.quote(weights, distances, costs, count);
+    }
+
+private:
+    CompiledRateCard rates;
+};
+
+// Registered shipping methods, indexed by shipping choice. Immutable; the
+// factory swaps in a new table when a method is registered or replaced.
+struct ShippingRegistry {
+    std::vector<std::shared_ptr<const ShippingMethod>> methods;
+    std::vector<std::uint64_t> versions;  // Rate card version per method, bumped on every replacement
+    std::uint64_t lastVersion = 0;
+    int defaultChoice = 0;
+
+    const std::shared_ptr<const ShippingMethod>& lookup(int shippingChoice) const {
+        if (shippingChoice < 0 || static_cast<std::size_t>(shippingChoice) >= methods.size() || !methods[shippingChoice]) {
+            return methods[defaultChoice];
+        }
+        return methods[shippingChoice];
     }
 };
 
-// Creator class (Factory) responsible for creating shipping methods
+// Built-in shipping methods; add a row to offer a new one. Unknown choices fall back to the default.
+const struct {
+    int choice;
+    std::shared_ptr<const ShippingMethod> (*create)();
+} kBuiltinShippingMethods[] = {
+    {1, []() -> std::shared_ptr<const ShippingMethod> { return std::make_shared<AirShipping>(); }},
+    {2, []() -> std::shared_ptr<const ShippingMethod> { return std::make_shared<SeaShipping>(); }},
+    {3, []() -> std::shared_ptr<const ShippingMethod> { return std::make_shared<GroundShipping>(); }},
+};
+const int kDefaultShippingChoice = 3;
+
+// Creator class (Factory) responsible for providing shipping methods
 class ShippingFactory {
 public:
-    static ShippingMethod* createShippingMethod(int shippingChoice) {
-        // Select the appropriate shipping method based on user choice
-        if (shippingChoice == 1) {
-            return new AirShipping();  // Create AirShipping
-        } else if (shippingChoice == 2) {
-            return new SeaShipping();  // Create SeaShipping
-        } else {
-            return new GroundShipping();  // Create GroundShipping
+    // Returns the shared instance for a choice; nothing is allocated per request
+    static std::shared_ptr<const ShippingMethod> createShippingMethod(int shippingChoice) {
+        return snapshot()->lookup(shippingChoice);
+    }
+
+    // Adds or replaces the method offered for a choice (e.g. after loading a new rate card)
+    static void registerMethod(int shippingChoice, std::shared_ptr<const ShippingMethod> method) {
+        if (shippingChoice < 0) {
+            throw std::invalid_argument("Shipping choice must not be negative");
         }
+        if (!method) {
+            throw std::invalid_argument("Cannot register a null shipping method");  // Lookups never return null
+        }
+        std::lock_guard<std::mutex> lock(writerMutex());
+        auto next = std::make_shared<ShippingRegistry>(*snapshot());
+        if (static_cast<std::size_t>(shippingChoice) >= next->methods.size()) {
+            next->methods.resize(shippingChoice + 1);
+            next->versions.resize(shippingChoice + 1);
+        }
+        next->methods[shippingChoice] = std::move(method);
+        next->versions[shippingChoice] = ++next->lastVersion;
+        std::atomic_store(&current(), std::shared_ptr<const ShippingRegistry>(std::move(next)));
+    }
+
+    static std::shared_ptr<const ShippingRegistry> snapshot() {
+        return std::atomic_load(&current());
+    }
+
+private:
+    static std::shared_ptr<const ShippingRegistry>& current() {
+        static std::shared_ptr<const ShippingRegistry> registry = [] {
+            auto builtins = std::make_shared<ShippingRegistry>();
+            for (const auto& entry : kBuiltinShippingMethods) {
+                if (static_cast<std::size_t>(entry.choice) >= builtins->methods.size()) {
+                    builtins->methods.resize(entry.choice + 1);
+                    builtins->versions.resize(entry.choice + 1);
+                }
+                builtins->methods[entry.choice] = entry.create();
+                builtins->versions[entry.choice] = ++builtins->lastVersion;
+            }
+            builtins->defaultChoice = kDefaultShippingChoice;
+            return std::shared_ptr<const ShippingRegistry>(std::move(builtins));
+        }();
+        return registry;
+    }
+
+    static std::mutex& writerMutex() {
+        static std::mutex mutex;
+        return mutex;
     }
 };
 
+// A shipment to be quoted in bulk
+struct Shipment {
+    int shippingChoice;
+    double weight;
+    double distance;
+};
+
+// Prices a mixed list of shipments. Shipments are grouped by method into
+// contiguous weight/distance arrays so each method prices its group in one batch.
+std::vector<double> quoteShipments(const std::vector<Shipment>& shipments) {
+    std::shared_ptr<const ShippingRegistry> registry = ShippingFactory::snapshot();
+    std::size_t groups = registry->methods.size();
+    auto group = [&registry](int choice) {
+        return &registry->lookup(choice) - registry->methods.data();
+    };
+
+    std::vector<std::size_t> start(groups + 1, 0);
+    for (const Shipment& s : shipments) {
+        ++start[group(s.shippingChoice) + 1];
+    }
+    for (std::size_t g = 0; g < groups; ++g) {
+        start[g + 1] += start[g];
+    }
+
+    std::vector<double> weights(shipments.size()), distances(shipments.size()), costs(shipments.size());
+    std::vector<std::size_t> position(shipments.size());
+    std::vector<std::size_t> next(start.begin(), start.end() - 1);
+    for (std::size_t i = 0; i < shipments.size(); ++i) {
+        std::size_t slot = next[group(shipments[i].shippingChoice)]++;
+        weights[slot] = shipments[i].weight;
+        distances[slot] = shipments[i].distance;
+        position[slot] = i;
+    }
+
+    for (std::size_t g = 0; g < groups; ++g) {
+        if (start[g + 1] > start[g]) {
+            registry->methods[g]->calculateShippingCosts(weights.data() + start[g], distances.data() + start[g],
+                                                         costs.data() + start[g], start[g + 1] - start[g]);
+        }
+    }
+
+    std::vector<double> quotes(shipments.size());
+    for (std::size_t slot = 0; slot < shipments.size(); ++slot) {
+        quotes[position[slot]] = costs[slot];
+    }
+    return quotes;
+}
+
+// One method's price for a shipment
+struct ShippingQuote {
+    int shippingChoice;
+    const ShippingMethod* method;  // Valid while the registry snapshot handed out with the quote is held
+    double cost;
+};
+
+// Prices one shipment with every registered method, cheapest first. registry
+// receives the snapshot that owns the quoted methods.
+std::vector<ShippingQuote> quoteAll(double weight, double distance, std::shared_ptr<const ShippingRegistry>& registry) {
+    registry = ShippingFactory::snapshot();
+    std::vector<ShippingQuote> quotes;
+    quotes.reserve(registry->methods.size());
+    for (std::size_t choice = 0; choice < registry->methods.size(); ++choice) {
+        if (const ShippingMethod* method = registry->methods[choice].get()) {
+            quotes.push_back({static_cast<int>(choice), method, method->calculateShippingCost(weight, distance)});
+        }
+    }
+    std::sort(quotes.begin(), quotes.end(), [](const ShippingQuote& a, const ShippingQuote& b) { return a.cost < b.cost; });
+    return quotes;
+}
+
+// Prices many shipments with every registered method. quotes receives one row
+// per shipment, each sorted cheapest first. Shipments are split into chunks
+// spread across cores; within a chunk each method runs its batch kernel once.
+void quoteAll(const double* weights, const double* distances, std::size_t count,
+              std::shared_ptr<const ShippingRegistry>& registry, std::vector<ShippingQuote>& quotes) {
+    registry = ShippingFactory::snapshot();
+    std::vector<int> choices;
+    for (std::size_t choice = 0; choice < registry->methods.size(); ++choice) {
+        if (registry->methods[choice]) {
+            choices.push_back(static_cast<int>(choice));
+        }
+    }
+    std::size_t methods = choices.size();
+    quotes.resize(count * methods);
+
+    const std::size_t kChunk = 4096;
+    std::size_t chunks = (count + kChunk - 1) / kChunk;
+    std::atomic<std::size_t> nextChunk(0);
+    auto worker = [&] {
+        std::vector<double> costs(methods * kChunk);
+        for (std::size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            std::size_t first = chunk * kChunk;
+            std::size_t size = std::min(kChunk, count - first);
+            for (std::size_t m = 0; m < methods; ++m) {
+                registry->methods[choices[m]]->calculateShippingCosts(weights + first, distances + first,
+                                                                      costs.data() + m * kChunk, size);
+            }
+            for (std::size_t i = 0; i < size; ++i) {
+                ShippingQuote* row = quotes.data() + (first + i) * methods;
+                for (std::size_t m = 0; m < methods; ++m) {
+                    // Insertion sort: rows hold only a handful of methods
+                    ShippingQuote quote = {choices[m], registry->methods[choices[m]].get(), costs[m * kChunk + i]};
+                    std::size_t j = m;
+                    for (; j > 0 && row[j - 1].cost > quote.cost; --j) {
+                        row[j] = row[j - 1];
+                    }
+                    row[j] = quote;
+                }
+            }
+        }
+    };
+
+    std::size_t threads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), chunks);
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+// A parcel awaiting consolidation; parcels with the same destination can travel together
+struct Parcel {
+    int destination;
+    double weight;
+    double distance;
+};
+
+// Parcels consolidated into one shipment with a single method
+struct ConsolidatedShipment {
+    int destination;
+    int shippingChoice;
+    double weight;
+    double distance;
+    double cost;
+    std::vector<std::size_t> parcels;  // Indices into the input
+};
+
+struct ConsolidationPlan {
+    std::vector<ConsolidatedShipment> shipments;
+    double totalCost = 0;
+};
+
+// First-fit-decreasing bin packing. A max segment tree over the bins' remaining
+// capacity finds the first bin that fits a parcel in O(log n). Parcels heavier
+// than the capacity travel alone.
+class BinPacker {
+public:
+    // weights must be sorted in decreasing order; returns the bin of each parcel
+    std::size_t pack(const std::vector<double>& weights, double capacity, std::vector<std::size_t>& binOf,
+                     std::vector<double>& binWeights) {
+        std::size_t size = 1;
+        while (size < weights.size()) {
+            size *= 2;
+        }
+        tree.assign(2 * size, capacity);
+        binOf.resize(weights.size());
+        binWeights.clear();
+
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            std::size_t bin;
+            if (weights[i] > capacity) {
+                bin = binWeights.size();  // Oversize: a bin of its own, never reused
+                take(size, bin, capacity);
+            } else {
+                std::size_t node = 1;
+                while (node < size) {
+                    node = tree[2 * node] >= weights[i] ? 2 * node : 2 * node + 1;
+                }
+                bin = node - size;
+                take(size, bin, weights[i]);
+            }
+            if (bin == binWeights.size()) {
+                binWeights.push_back(0);
+            }
+            binWeights[bin] += weights[i];
+            binOf[i] = bin;
+        }
+        return binWeights.size();
+    }
+
+private:
+    void take(std::size_t size, std::size_t bin, double weight) {
+        std::size_t node = bin + size;
+        tree[node] -= weight;
+        for (node /= 2; node > 0; node /= 2) {
+            tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+
+    std::vector<double> tree;
+};
+
+// Groups parcels by destination, packs each group for every method that has a
+// capacity (capacityByChoice[choice] > 0) and keeps the cheapest packing.
+ConsolidationPlan consolidate(const std::vector<Parcel>& parcels, const std::vector<double>& capacityByChoice) {
+    std::shared_ptr<const ShippingRegistry> registry = ShippingFactory::snapshot();
+
+    // Heaviest first within each destination, as first-fit-decreasing requires
+    std::vector<std::size_t> order(parcels.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&parcels](std::size_t a, std::size_t b) {
+        if (parcels[a].destination != parcels[b].destination) {
+            return parcels[a].destination < parcels[b].destination;
+        }
+        return parcels[a].weight > parcels[b].weight;
+    });
+
+    ConsolidationPlan plan;
+    BinPacker packer;
+    std::vector<double> weights, binWeights, bestWeights, distances, costs, bestCosts;
+    std::vector<std::size_t> binOf, bestBinOf;
+    for (std::size_t first = 0, last; first < order.size(); first = last) {
+        int destination = parcels[order[first]].destination;
+        double distance = 0;
+        weights.clear();
+        for (last = first; last < order.size() && parcels[order[last]].destination == destination; ++last) {
+            weights.push_back(parcels[order[last]].weight);
+            distance = std::max(distance, parcels[order[last]].distance);
+        }
+
+        double bestCost = std::numeric_limits<double>::infinity();
+        int bestChoice = -1;
+        for (std::size_t choice = 0; choice < registry->methods.size() && choice < capacityByChoice.size(); ++choice) {
+            const ShippingMethod* method = registry->methods[choice].get();
+            if (!method || capacityByChoice[choice] <= 0) {
+                continue;
+            }
+            std::size_t bins = packer.pack(weights, capacityByChoice[choice], binOf, binWeights);
+            distances.assign(bins, distance);
+            costs.resize(bins);
+            method->calculateShippingCosts(binWeights.data(), distances.data(), costs.data(), bins);
+            double cost = 0;
+            for (double c : costs) {
+                cost += c;
+            }
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestChoice = static_cast<int>(choice);
+                bestBinOf.swap(binOf);
+                bestWeights.swap(binWeights);
+                bestCosts.swap(costs);
+            }
+        }
+        if (bestChoice < 0) {
+            throw std::invalid_argument("no shipping method has a consolidation capacity");
+        }
+
+        std::size_t base = plan.shipments.size();
+        for (std::size_t bin = 0; bin < bestWeights.size(); ++bin) {
+            plan.shipments.push_back({destination, bestChoice, bestWeights[bin], distance, bestCosts[bin], {}});
+        }
+        for (std::size_t i = first; i < last; ++i) {
+            plan.shipments[base + bestBinOf[i - first]].parcels.push_back(order[i]);
+        }
+        plan.totalCost += bestCost;
+    }
+    return plan;
+}
+
+// Caches single-shipment quotes. Weight and distance are rounded up to buckets
+// so nearby requests share an entry; a cached quote is the price at the bucket's
+// upper edge, which can undercut the exact price when a cheaper rate bracket
+// starts inside the bucket. Keys carry the rate card's version so a reloaded
+// card can never serve stale prices. Entries are spread over independently
+// locked shards.
+class QuoteCache {
+public:
+    QuoteCache(double weightStep = 0.5, double distanceStep = 10, std::size_t entriesPerShard = 1 << 14)
+        : weightStep(weightStep), distanceStep(distanceStep), entriesPerShard(entriesPerShard) {}
+
+    double quote(int shippingChoice, double weight, double distance) {
+        std::shared_ptr<const ShippingRegistry> registry = ShippingFactory::snapshot();
+        const std::shared_ptr<const ShippingMethod>& method = registry->lookup(shippingChoice);
+        std::size_t slot = &method - registry->methods.data();
+        double weightBucket = std::ceil(weight / weightStep);
+        double distanceBucket = std::ceil(distance / distanceStep);
+        if (!(std::fabs(weightBucket) < kMaxBucket && std::fabs(distanceBucket) < kMaxBucket)) {
+            return method->calculateShippingCost(weight, distance);  // NaN or too large to key; price it uncached
+        }
+        Key key = {static_cast<std::uint32_t>(slot), registry->versions[slot], static_cast<std::int64_t>(weightBucket),
+                   static_cast<std::int64_t>(distanceBucket)};
+
+        Shard& shard = shards[KeyHash()(key) % kShards];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.quotes.find(key);
+            if (it != shard.quotes.end()) {
+                ++shard.hits;
+                return it->second;
+            }
+            ++shard.misses;
+        }
+
+        double cost = method->calculateShippingCost(key.weightBucket * weightStep, key.distanceBucket * distanceStep);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.quotes.size() >= entriesPerShard) {
+            shard.quotes.clear();  // Crude bound; popular lanes repopulate immediately
+        }
+        shard.quotes.emplace(key, cost);
+        return cost;
+    }
+
+    // Drops every entry for a method; call after reloading its rate card
+    void invalidate(int shippingChoice) {
+        std::shared_ptr<const ShippingRegistry> registry = ShippingFactory::snapshot();
+        std::size_t slot = &registry->lookup(shippingChoice) - registry->methods.data();  // Same slot quote() keys on
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.quotes.begin(); it != shard.quotes.end();) {
+                it = it->first.slot == slot ? shard.quotes.erase(it) : std::next(it);
+            }
+        }
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.quotes.clear();
+        }
+    }
+
+    double hitRate() {
+        std::size_t hits = 0, lookups = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            hits += shard.hits;
+            lookups += shard.hits + shard.misses;
+        }
+        return lookups ? static_cast<double>(hits) / lookups : 0;
+    }
+
+private:
+    struct Key {
+        std::uint32_t slot;
+        std::uint64_t version;
+        std::int64_t weightBucket;
+        std::int64_t distanceBucket;
+
+        bool operator==(const Key& other) const {
+            return slot == other.slot && version == other.version && weightBucket == other.weightBucket &&
+                   distanceBucket == other.distanceBucket;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::uint64_t h = key.slot * 0x9e3779b97f4a7c15ULL ^ key.version;
+            h = (h ^ static_cast<std::uint64_t>(key.weightBucket)) * 0xff51afd7ed558ccdULL;
+            h = (h ^ static_cast<std::uint64_t>(key.distanceBucket)) * 0xc4ceb9fe1a85ec53ULL;
+            return static_cast<std::size_t>(h ^ (h >> 33));
+        }
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, double, KeyHash> quotes;
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+    };
+
+    static const std::size_t kShards = 64;
+    static constexpr double kMaxBucket = 9007199254740992.0;  // 2^53: exact in a double and well inside int64_t
+
+    const double weightStep;
+    const double distanceStep;
+    const std::size_t entriesPerShard;
+    Shard shards[kShards];
+};
+
+// Bounded multi-producer/multi-consumer ring buffer (Vyukov). Each slot carries a
+// sequence number telling producers and consumers whose turn it is, so push and
+// pop are a single CAS on the shared index in the uncontended case.
+template <typename T>
+class BoundedMpmcQueue {
+public:
+    explicit BoundedMpmcQueue(std::size_t capacity) : mask(roundUp(capacity) - 1), slots(mask + 1) {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(T value) {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & mask];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& value) {
+        std::size_t position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & mask];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(slot.value);
+                    slot.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Empty
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static std::size_t roundUp(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    const std::size_t mask;
+    std::vector<Slot> slots;
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+
+// Token bucket limiting how fast requests reach one carrier
+class RateLimiter {
+public:
+    RateLimiter(double perSecond, double burst) : rate(perSecond), capacity(burst), tokens(burst),
+                                                  last(std::chrono::steady_clock::now()) {}
+
+    // Blocks until a token is available
+    void acquire() {
+        std::chrono::duration<double> wait;
+        while (!tryAcquire(&wait)) {
+            std::this_thread::sleep_for(wait);
+        }
+    }
+
+    // Takes a token if one is available; otherwise reports how long until the next one
+    bool tryAcquire(std::chrono::duration<double>* wait = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = std::chrono::steady_clock::now();
+        tokens = std::min(capacity, tokens + rate * std::chrono::duration<double>(now - last).count());
+        last = now;
+        if (tokens >= 1) {
+            tokens -= 1;
+            return true;
+        }
+        if (wait) {
+            *wait = std::chrono::duration<double>((1 - tokens) / rate);
+        }
+        return false;
+    }
+
+    // Gives back a token that was acquired but not spent
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        tokens = std::min(capacity, tokens + 1);
+    }
+
+private:
+    std::mutex mutex;
+    const double rate;
+    const double capacity;
+    double tokens;
+    std::chrono::steady_clock::time_point last;
+};
+
+// A booking request; the idempotency key makes client retries safe
+struct BookingRequest {
+    std::string idempotencyKey;
+    int shippingChoice;
+    double weight;
+    double distance;
+};
+
+// Client for a carrier's booking API; returns the carrier's confirmation number
+class CarrierClient {
+public:
+    virtual std::string book(const ShippingMethod& method, const BookingRequest& request) = 0;
+    virtual ~CarrierClient() {}
+};
+
+// Local stand-in for carrier APIs that simulates network latency
+class FakeCarrier : public CarrierClient {
+public:
+    explicit FakeCarrier(std::chrono::microseconds latency) : latency(latency) {}
+
+    std::string book(const ShippingMethod& method, const BookingRequest& request) override {
+        std::this_thread::sleep_for(latency);
+        return std::string(method.name()) + "-" + std::to_string(++confirmations) + "-" + request.idempotencyKey;
+    }
+
+    std::size_t booked() const { return confirmations.load(); }
+
+private:
+    std::chrono::microseconds latency;
+    std::atomic<std::size_t> confirmations{0};
+};
+
+// Asynchronous booking: request threads enqueue and return immediately; a
+// worker pool books with the carriers under per-carrier rate limits. Each
+// carrier has its own lane, and workers only take from lanes with a token to
+// spare, so a throttled carrier never ties up workers other carriers need.
+// Finished results are kept for resultTtl so clients can poll them and retries
+// stay idempotent, then evicted.
+class BookingPipeline {
+public:
+    enum class Status { Queued, Booked, Failed, Duplicate, Rejected };
+
+    BookingPipeline(std::shared_ptr<CarrierClient> carrier, std::size_t workers, std::size_t queueCapacity,
+                    double bookingsPerSecondPerCarrier, std::chrono::seconds resultTtl = std::chrono::hours(1))
+        : carrier(std::move(carrier)), resultTtl(resultTtl) {
+        for (const auto& method : ShippingFactory::snapshot()->methods) {
+            lanes.emplace_back(new Lane(queueCapacity));
+            if (method) {
+                lanes.back()->limiter.reset(new RateLimiter(bookingsPerSecondPerCarrier, bookingsPerSecondPerCarrier / 10 + 1));
+            }
+        }
+        lanes.emplace_back(new Lane(queueCapacity));  // Unthrottled, for methods registered after construction
+        for (std::size_t i = 0; i < workers; ++i) {
+            pool.emplace_back(&BookingPipeline::work, this);
+        }
+    }
+
+    ~BookingPipeline() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : pool) {
+            worker.join();
+        }
+    }
+
+    // Queued for a new key, Duplicate if the key was seen before, Rejected if the carrier's lane is full
+    Status submit(BookingRequest request) {
+        Shard& shard = shardFor(request.idempotencyKey);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.results.emplace(request.idempotencyKey, Result{Status::Queued, "", {}}).second) {
+                return Status::Duplicate;
+            }
+        }
+        std::shared_ptr<const ShippingRegistry> registry = ShippingFactory::snapshot();
+        std::size_t slot = &registry->lookup(request.shippingChoice) - registry->methods.data();
+        Lane& lane = *lanes[std::min(slot, lanes.size() - 1)];
+        std::string key = request.idempotencyKey;
+        pending++;  // Before the push, so a worker can never finish the booking first and wrap the count
+        if (!lane.queue.tryPush(std::move(request))) {
+            finishOne();
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.results.erase(key);  // Let the client retry with the same key
+            return Status::Rejected;
+        }
+        lane.waiting++;
+        submitted++;
+        {
+            // An idle worker holds wakeMutex from reading submitted until it waits, so this can't be missed
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wake.notify_one();
+        return Status::Queued;
+    }
+
+    Status status(const std::string& idempotencyKey, std::string* confirmation = nullptr) {
+        Shard& shard = shardFor(idempotencyKey);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.results.find(idempotencyKey);
+        if (it == shard.results.end()) {
+            return Status::Rejected;
+        }
+        if (confirmation) {
+            *confirmation = it->second.confirmation;
+        }
+        return it->second.status;
+    }
+
+    // Waits until every accepted booking has been processed
+    void drain() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        drained.wait(lock, [this] { return pending.load() == 0; });
+    }
+
+private:
+    struct Result {
+        Status status;
+        std::string confirmation;
+        std::chrono::steady_clock::time_point finished;
+    };
+
+    // Idempotency records are striped across shards to keep submit contention low
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Result> results;
+        std::deque<std::pair<std::chrono::steady_clock::time_point, std::string>> expiry;  // In finishing order
+    };
+
+    // Requests bound for one carrier
+    struct Lane {
+        explicit Lane(std::size_t capacity) : queue(capacity) {}
+
+        BoundedMpmcQueue<BookingRequest> queue;
+        std::atomic<std::size_t> waiting{0};   // Requests pushed and not yet taken
+        std::unique_ptr<RateLimiter> limiter;  // Null for unthrottled lanes
+    };
+
+    Shard& shardFor(const std::string& key) {
+        return shards[std::hash<std::string>()(key) % kShards];
+    }
+
+    // Takes a request from the first lane, starting at cursor, that has work and
+    // a token to spend; throttled lanes are skipped rather than waited on. On
+    // failure, retryIn is the soonest a throttled lane with work gets a token.
+    bool tryTake(std::size_t& cursor, BookingRequest& request, std::chrono::duration<double>& retryIn) {
+        retryIn = std::chrono::duration<double>::max();
+        for (std::size_t k = 0; k < lanes.size(); ++k) {
+            std::size_t index = (cursor + k) % lanes.size();
+            Lane& lane = *lanes[index];
+            if (lane.waiting.load() == 0) {
+                continue;
+            }
+            std::chrono::duration<double> wait;
+            if (lane.limiter && !lane.limiter->tryAcquire(&wait)) {
+                retryIn = std::min(retryIn, wait);
+                continue;
+            }
+            if (lane.queue.tryPop(request)) {
+                lane.waiting--;
+                cursor = index + 1;  // Rotate so busy lanes don't starve the others
+                return true;
+            }
+            if (lane.limiter) {
+                lane.limiter->release();
+            }
+        }
+        return false;
+    }
+
+    // Drops one accepted booking from the count; at zero, wakes drain() and any
+    // workers waiting to shut down
+    void finishOne() {
+        if (--pending == 0) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            drained.notify_all();
+            wake.notify_all();
+        }
+    }
+
+    void work() {
+        BookingRequest request;
+        std::size_t cursor = 0;
+        while (!stopping || pending.load() > 0) {
+            std::size_t seen = submitted.load();
+            std::chrono::duration<double> retryIn;
+            if (!tryTake(cursor, request, retryIn)) {
+                // Sleep until new work arrives, or until a throttled lane earns a token
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                auto ready = [&] { return submitted.load() != seen || (stopping && pending.load() == 0); };
+                if (retryIn == std::chrono::duration<double>::max()) {
+                    wake.wait(lock, ready);
+                } else {
+                    wake.wait_for(lock, retryIn, ready);
+                }
+                continue;
+            }
+
+            std::shared_ptr<const ShippingRegistry> registry = ShippingFactory::snapshot();
+            const std::shared_ptr<const ShippingMethod>& method = registry->lookup(request.shippingChoice);
+            Result result{Status::Failed, "", {}};
+            try {
+                result = {Status::Booked, carrier->book(*method, request), {}};
+            } catch (const std::exception&) {
+                // Leave the booking marked Failed; the client can resubmit under a new key
+            }
+            result.finished = std::chrono::steady_clock::now();
+            Shard& shard = shardFor(request.idempotencyKey);
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                // Each completion retires the shard's expired results, so the map stays bounded by the TTL
+                while (!shard.expiry.empty() && result.finished - shard.expiry.front().first >= resultTtl) {
+                    auto it = shard.results.find(shard.expiry.front().second);
+                    if (it != shard.results.end() && it->second.finished == shard.expiry.front().first) {
+                        shard.results.erase(it);
+                    }
+                    shard.expiry.pop_front();
+                }
+                shard.expiry.emplace_back(result.finished, request.idempotencyKey);
+                shard.results[request.idempotencyKey] = std::move(result);
+            }
+            finishOne();
+        }
+    }
+
+    static const std::size_t kShards = 64;
+
+    std::shared_ptr<CarrierClient> carrier;
+    std::vector<std::unique_ptr<Lane>> lanes;  // Indexed by registry slot, plus one trailing unthrottled lane
+    const std::chrono::seconds resultTtl;
+    Shard shards[kShards];
+    std::atomic<std::size_t> pending{0};
+    std::atomic<std::size_t> submitted{0};  // Bumped per accepted request so idle workers can tell they missed one
+    std::atomic<bool> stopping{false};
+    std::mutex wakeMutex;
+    std::condition_variable wake;     // New work, or shutdown with nothing pending
+    std::condition_variable drained;  // pending reached zero
+    std::vector<std::thread> pool;
+};
+
 // Client Code to use the Factory Method
 int main() {
     int shippingChoice;
     std::cout << "Enter shipping method (1 for Air, 2 for Sea, 3 for Ground): ";
     std::cin >> shippingChoice;
 
-    // Use the factory to create the appropriate shipping method based on user choice
-    ShippingMethod* shippingMethod = ShippingFactory::createShippingMethod(shippingChoice);
+    // Use the factory to get the appropriate shipping method based on user choice
+    std::shared_ptr<const ShippingMethod> shippingMethod = ShippingFactory::createShippingMethod(shippingChoice);
 
     // Book the shipment and calculate cost for a weight of 10 kg and distance of 500 km
     shippingMethod->bookShipment();
     double cost = shippingMethod->calculateShippingCost(10, 500);
     std::cout << "Shipping cost: $" << cost << std::endl;
 
-    // Clean up
-    delete shippingMethod;
+    // Quote a large batch of mixed shipments in one call
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> weight(0.5, 50.0), distance(10.0, 5000.0);
+    std::vector<Shipment> shipments(1000000);
+    for (Shipment& s : shipments) {
+        s = {static_cast<int>(rng() % 3) + 1, weight(rng), distance(rng)};
+    }
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<double> quotes = quoteShipments(shipments);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Quoted " << quotes.size() << " shipments in " << ms << " ms (first: $" << quotes[0] << ")" << std::endl;
+
+    // Compare every carrier for one shipment
+    std::cout << "Quotes for 10 kg over 500 km:";
+    std::shared_ptr<const ShippingRegistry> quoted;
+    for (const ShippingQuote& quote : quoteAll(10, 500, quoted)) {
+        std::cout << " " << quote.method->name() << " $" << quote.cost;
+    }
+    std::cout << std::endl;
+
+    // A carrier rate card with weight brackets, distance zones, surcharges and a minimum
+    RateCard card;
+    card.weightBounds = {1, 5, 20, 70};
+    card.zoneBounds = {100, 500, 2000};
+    card.rates = {
+        0.90, 0.70, 0.55, 0.50,  // up to 1 kg
+        0.60, 0.45, 0.35, 0.30,  // up to 5 kg
+        0.40, 0.30, 0.25, 0.20,  // up to 20 kg
+        0.30, 0.22, 0.18, 0.15,  // up to 70 kg
+        0.25, 0.18, 0.15, 0.12,  // heavier
+    };
+    card.handlingFee = 4.5;
+    card.fuelSurcharge = 0.12;
+    card.minimumCharge = 9.99;
+    QuoteCache cache;
+    std::cout << "Cached quote before reload: $" << cache.quote(1, 10, 500) << std::endl;
+    ShippingFactory::registerMethod(1, std::make_shared<AirShipping>(card));
+    cache.invalidate(1);
+    std::cout << "Cached quote after reload: $" << cache.quote(1, 10, 500) << std::endl;
+    std::shared_ptr<const ShippingMethod> carrier = ShippingFactory::createShippingMethod(1);
+    std::cout << "Rate card quote for 10 kg over 500 km: $" << carrier->calculateShippingCost(10, 500) << std::endl;
+
+    std::vector<double> weights(shipments.size()), distances(shipments.size());
+    for (std::size_t i = 0; i < shipments.size(); ++i) {
+        weights[i] = shipments[i].weight;
+        distances[i] = shipments[i].distance;
+    }
+    begin = std::chrono::steady_clock::now();
+    carrier->calculateShippingCosts(weights.data(), distances.data(), quotes.data(), quotes.size());
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Rate card quotes: " << ns / quotes.size() << " ns per shipment" << std::endl;
+
+    // Quote requests cluster around common parcel sizes and lanes
+    std::vector<double> commonWeights = {0.5, 1, 2, 2.5, 5, 10, 20}, commonDistances = {120, 350, 800, 1500, 2600};
+    begin = std::chrono::steady_clock::now();
+    double total = 0;
+    for (std::size_t i = 0; i < shipments.size(); ++i) {
+        double w = commonWeights[rng() % commonWeights.size()] + (rng() % 10) * 0.01;
+        double d = commonDistances[rng() % commonDistances.size()] + rng() % 20;
+        total += cache.quote(shipments[i].shippingChoice, w, d);
+    }
+    ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Cached quotes: " << ns / shipments.size() << " ns per quote, hit rate " << cache.hitRate() * 100
+              << "% (total $" << total << ")" << std::endl;
+
+    // Cheapest carrier for every shipment in the batch
+    std::shared_ptr<const ShippingRegistry> registry;
+    std::vector<ShippingQuote> table;
+    begin = std::chrono::steady_clock::now();
+    quoteAll(weights.data(), distances.data(), weights.size(), registry, table);
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Compared all carriers for " << weights.size() << " shipments in " << ms << " ms; cheapest for the first: "
+              << table[0].method->name() << " $" << table[0].cost << std::endl;
+
+    // Consolidate parcels headed to the same destinations before choosing a method
+    std::vector<Parcel> parcels(100000);
+    std::vector<double> laneDistances(2000);
+    for (double& d : laneDistances) {
+        d = distance(rng);
+    }
+    for (Parcel& p : parcels) {
+        p.destination = static_cast<int>(rng() % laneDistances.size());
+        p.weight = weight(rng);
+        p.distance = laneDistances[p.destination];
+    }
+    RateCard freight;  // Ground freight: cheaper per kg for heavier loads, fixed fee per shipment
+    freight.weightBounds = {30, 300};
+    freight.rates = {0.12, 0.09, 0.07};
+    freight.handlingFee = 25;
+    freight.minimumCharge = 15;
+    ShippingFactory::registerMethod(3, std::make_shared<GroundShipping>(freight));
+    double separateCost = 0;
+    for (const Parcel& p : parcels) {
+        separateCost += quoteAll(p.weight, p.distance, quoted).front().cost;
+    }
+    begin = std::chrono::steady_clock::now();
+    ConsolidationPlan plan = consolidate(parcels, {0, 500, 20000, 1000});
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Consolidated " << parcels.size() << " parcels into " << plan.shipments.size() << " shipments in " << ms
+              << " ms: $" << plan.totalCost << " vs $" << separateCost << " shipped separately" << std::endl;
+
+    // Book through the asynchronous pipeline against a fake carrier with 2 ms latency
+    auto fakeCarrier = std::make_shared<FakeCarrier>(std::chrono::microseconds(2000));
+    const std::size_t kBookings = 10000;
+    std::atomic<std::size_t> duplicates(0);
+    double enqueueMicros = 0;
+    begin = std::chrono::steady_clock::now();
+    {
+        BookingPipeline pipeline(fakeCarrier, 32, 16384, 5000);
+        std::vector<std::thread> clients;
+        std::vector<double> clientMicros(4, 0);
+        for (std::size_t c = 0; c < clientMicros.size(); ++c) {
+            clients.emplace_back([&, c] {
+                for (std::size_t i = c; i < kBookings; i += clientMicros.size()) {
+                    BookingRequest request{"order-" + std::to_string(i), static_cast<int>(i % 3) + 1, 5, 300};
+                    auto start = std::chrono::steady_clock::now();
+                    pipeline.submit(request);
+                    clientMicros[c] += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                    if (i % 100 == 0 && pipeline.submit(request) == BookingPipeline::Status::Duplicate) {
+                        ++duplicates;  // A client retry is absorbed by the idempotency key
+                    }
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        for (double micros : clientMicros) {
+            enqueueMicros += micros;
+        }
+        pipeline.drain();
+
+        std::string confirmation;
+        pipeline.status("order-42", &confirmation);
+        std::cout << "Booking order-42 confirmed as " << confirmation << std::endl;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Booked " << fakeCarrier->booked() << " shipments in " << seconds << " s ("
+              << fakeCarrier->booked() / seconds << "/s), " << enqueueMicros / kBookings << " us per enqueue, "
+              << duplicates << " duplicate retries ignored" << std::endl;
 
     return 0;
 }
@@ -8,88 +8,1095 @@
    The Prototype Pattern can help by cloning an existing character prototype and making necessary adjustments, rather than creating a new one from scratch.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <typeinfo>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Numeric attributes every character carries
+enum Stat { Health, Mana, Stamina, Strength, Agility, Intellect, Armor, Resistance, Speed, Range, kStatCount };
+
+// A prototype's state, shared read-only by the prototype and all of its clones.
+// Plain data; names longer than 31 characters are truncated.
+struct CharacterTraits {
+    char name[32];
+    std::int32_t stats[kStatCount];
+
+    static std::shared_ptr<const CharacterTraits> make(const std::string& name, std::initializer_list<std::int32_t> stats) {
+        auto traits = std::make_shared<CharacterTraits>();
+        std::size_t length = std::min(name.size(), sizeof(traits->name) - 1);
+        std::copy(name.begin(), name.begin() + length, traits->name);
+        traits->name[length] = '\0';
+        std::fill(traits->stats, traits->stats + kStatCount, 0);
+        std::copy(stats.begin(), stats.begin() + std::min<std::size_t>(stats.size(), kStatCount), traits->stats);
+        return traits;
+    }
+};
+
+// Concrete prototype classes, as stored in catalogs
+enum CharacterKind : std::uint32_t { WarriorKind, MageKind, ArcherKind };
+
+// Fields a single character has changed; allocated on the first change
+struct CharacterOverrides {
+    std::uint32_t mask = 0;  // Bit s set when stats[s] overrides the shared value
+    std::int32_t stats[kStatCount];
+    bool renamed = false;
+    std::string name;
+};
+
+// A node in a character's gear graph: items (which may contain other items)
+// and skills (which may require other skills). Nodes can be shared, e.g. one
+// charm referenced from two bags, and may form cycles, e.g. skills that
+// reinforce each other.
+struct GearNode {
+    enum Kind : std::uint8_t { Item, Skill };
+
+    Kind kind;
+    std::int32_t value;  // Item weight or skill rank
+    char name[24];
+    std::uint32_t linkCount;
+    GearNode** links;  // Contained items or required skills
+};
+
+// A gear graph whose nodes and links all live in one arena allocation.
+// Not copyable; deepClone() makes an independent copy.
+class GearGraph {
+public:
+    struct Spec {
+        GearNode::Kind kind;
+        std::string name;
+        std::int32_t value;
+        std::vector<std::uint32_t> links;  // Indices into the spec list
+    };
+
+    GearGraph(const std::vector<Spec>& specs, std::uint32_t root) {
+        std::size_t links = 0;
+        for (const Spec& spec : specs) {
+            links += spec.links.size();
+        }
+        allocate(specs.size(), links);
+        GearNode** next = linkStorage;
+        for (std::size_t i = 0; i < specs.size(); ++i) {
+            GearNode& node = nodes[i];
+            node.kind = specs[i].kind;
+            node.value = specs[i].value;
+            std::size_t length = std::min(specs[i].name.size(), sizeof(node.name) - 1);
+            std::fill(node.name, node.name + sizeof(node.name), '\0');
+            std::copy(specs[i].name.begin(), specs[i].name.begin() + length, node.name);
+            node.linkCount = static_cast<std::uint32_t>(specs[i].links.size());
+            node.links = next;
+            for (std::uint32_t link : specs[i].links) {
+                *next++ = &nodes[link];
+            }
+        }
+        rootNode = &nodes[root];
+    }
+
+    GearGraph(GearGraph&&) = default;
+    GearGraph& operator=(GearGraph&&) = default;
+
+    const GearNode* root() const {
+        return rootNode;
+    }
+
+    GearNode* root() {
+        return rootNode;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    std::size_t memoryBytes() const {
+        return arenaBytes;
+    }
+
+    // Copies every node reachable from the root into a single new arena. The
+    // visited map sends each original to exactly one copy, so shared nodes stay
+    // shared and cycles terminate.
+    GearGraph deepClone() const {
+        std::unordered_map<const GearNode*, std::uint32_t> visited;
+        visited.reserve(count);
+        std::vector<const GearNode*> order;
+        order.reserve(count);
+        std::vector<const GearNode*> stack(1, rootNode);
+        std::size_t links = 0;
+        visited.emplace(rootNode, 0);
+        order.push_back(rootNode);
+        while (!stack.empty()) {
+            const GearNode* node = stack.back();
+            stack.pop_back();
+            links += node->linkCount;
+            for (std::uint32_t l = 0; l < node->linkCount; ++l) {
+                if (visited.emplace(node->links[l], static_cast<std::uint32_t>(order.size())).second) {
+                    order.push_back(node->links[l]);
+                    stack.push_back(node->links[l]);
+                }
+            }
+        }
+
+        GearGraph copy;
+        copy.allocate(order.size(), links);
+        GearNode** next = copy.linkStorage;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            GearNode& node = copy.nodes[i];
+            node = *order[i];
+            node.links = next;
+            for (std::uint32_t l = 0; l < node.linkCount; ++l) {
+                *next++ = &copy.nodes[visited.find(order[i]->links[l])->second];
+            }
+        }
+        copy.rootNode = copy.nodes;
+        return copy;
+    }
+
+private:
+    GearGraph() = default;
+
+    void allocate(std::size_t nodeCount, std::size_t linkCount) {
+        arenaBytes = nodeCount * sizeof(GearNode) + linkCount * sizeof(GearNode*);
+        arena.reset(new std::max_align_t[(arenaBytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]);
+        nodes = reinterpret_cast<GearNode*>(arena.get());
+        linkStorage = reinterpret_cast<GearNode**>(nodes + nodeCount);
+        count = nodeCount;
+    }
+
+    std::unique_ptr<std::max_align_t[]> arena;
+    GearNode* nodes = nullptr;
+    GearNode** linkStorage = nullptr;
+    GearNode* rootNode = nullptr;
+    std::size_t count = 0;
+    std::size_t arenaBytes = 0;
+};
 
 // Prototype Interface
+// Characters are copy-on-write: a clone shares its prototype's traits and gear
+// and only allocates overrides, or its own gear, once it diverges, so cloning
+// copies a few pointers and a header.
 class Character {
 public:
+    explicit Character(std::shared_ptr<const CharacterTraits> traits) : traits(std::move(traits)) {}
+
+    Character(const Character& other)
+        : traits(other.traits), gear(other.gear),
+          overrides(other.overrides ? new CharacterOverrides(*other.overrides) : nullptr) {}
+
+    Character& operator=(const Character& other) {
+        traits = other.traits;
+        gear = other.gear;
+        if (!other.overrides) {
+            if (overrides) {
+                overrides->mask = 0;  // Keep the allocation for the next divergence
+                overrides->renamed = false;
+            }
+        } else if (overrides) {
+            *overrides = *other.overrides;
+        } else {
+            overrides.reset(new CharacterOverrides(*other.overrides));
+        }
+        return *this;
+    }
+
     virtual Character* clone() const = 0;
+    // Pool support: copy into raw storage, or overwrite a recycled instance in
+    // place (returns false if the recycled instance has a different type)
+    virtual Character* cloneInto(void* storage) const = 0;
+    virtual bool assignTo(Character& recycled) const = 0;
     virtual void showDetails() const = 0;
+    virtual CharacterKind kind() const = 0;
     virtual ~Character() {}
+
+    const char* name() const {
+        return overrides && overrides->renamed ? overrides->name.c_str() : traits->name;
+    }
+
+    std::int32_t stat(Stat s) const {
+        return overrides && (overrides->mask >> s & 1) ? overrides->stats[s] : traits->stats[s];
+    }
+
+    void rename(const std::string& name) {
+        divergent().renamed = true;
+        overrides->name = name;
+    }
+
+    void setStat(Stat s, std::int32_t value) {
+        divergent().stats[s] = value;
+        overrides->mask |= 1u << s;
+    }
+
+    // Clone whose gear graph is copied up front rather than on first change
+    Character* cloneDeep() const {
+        Character* copy = clone();
+        if (gear) {
+            copy->gear = std::make_shared<GearGraph>(gear->deepClone());
+        }
+        return copy;
+    }
+
+    void equip(std::shared_ptr<GearGraph> graph) {
+        gear = std::move(graph);
+    }
+
+    const GearGraph* equipment() const {
+        return gear.get();
+    }
+
+    // Gear this character may change; deep-cloned first while still shared
+    GearGraph* mutableEquipment() {
+        if (gear && gear.use_count() > 1) {
+            gear = std::make_shared<GearGraph>(gear->deepClone());
+        }
+        return gear.get();
+    }
+
+    const std::shared_ptr<const CharacterTraits>& sharedTraits() const {
+        return traits;
+    }
+
+    // The shared traits with this character's overrides applied
+    CharacterTraits effectiveTraits() const {
+        CharacterTraits effective = *traits;
+        std::string current = name();
+        std::size_t length = std::min(current.size(), sizeof(effective.name) - 1);
+        std::fill(effective.name, effective.name + sizeof(effective.name), '\0');
+        std::copy(current.begin(), current.begin() + length, effective.name);
+        for (int s = 0; s < kStatCount; ++s) {
+            effective.stats[s] = stat(static_cast<Stat>(s));
+        }
+        return effective;
+    }
+
+    // Memory this character owns beyond its fixed header; shared traits are not counted
+    std::size_t ownedBytes() const {
+        return overrides ? sizeof(CharacterOverrides) : 0;
+    }
+
+protected:
+    std::shared_ptr<const CharacterTraits> traits;
+    std::shared_ptr<GearGraph> gear;  // Shared with clones; treated as immutable while shared
+
+private:
+    CharacterOverrides& divergent() {
+        if (!overrides) {
+            overrides.reset(new CharacterOverrides);
+        }
+        return *overrides;
+    }
+
+    std::unique_ptr<CharacterOverrides> overrides;
 };
 
 // Concrete Prototype: Warrior
 class Warrior : public Character {
 public:
-    Warrior(const std::string& name) : name(name) {}
+    Warrior(const std::string& name) : Character(CharacterTraits::make(name, {180, 20, 120, 30, 12, 5, 40, 10, 5, 1})) {}
+    explicit Warrior(std::shared_ptr<const CharacterTraits> traits) : Character(std::move(traits)) {}
 
     Character* clone() const override {
         return new Warrior(*this);  // Clone the Warrior
     }
 
+    Character* cloneInto(void* storage) const override {
+        return new (storage) Warrior(*this);
+    }
+
+    bool assignTo(Character& recycled) const override {
+        if (typeid(recycled) != typeid(Warrior)) {
+            return false;
+        }
+        static_cast<Warrior&>(recycled) = *this;  // Reuses the recycled overrides' allocation
+        return true;
+    }
+
     void showDetails() const override {
-        std::cout << "Warrior: " << name << std::endl;
+        std::cout << "Warrior: " << name() << std::endl;
     }
 
-private:
-    std::string name;
+    CharacterKind kind() const override {
+        return WarriorKind;
+    }
 };
 
 // Concrete Prototype: Mage
 class Mage : public Character {
 public:
-    Mage(const std::string& name) : name(name) {}
+    Mage(const std::string& name) : Character(CharacterTraits::make(name, {90, 200, 60, 6, 10, 35, 8, 30, 5, 12})) {}
+    explicit Mage(std::shared_ptr<const CharacterTraits> traits) : Character(std::move(traits)) {}
 
     Character* clone() const override {
         return new Mage(*this);  // Clone the Mage
     }
 
+    Character* cloneInto(void* storage) const override {
+        return new (storage) Mage(*this);
+    }
+
+    bool assignTo(Character& recycled) const override {
+        if (typeid(recycled) != typeid(Mage)) {
+            return false;
+        }
+        static_cast<Mage&>(recycled) = *this;  // Reuses the recycled overrides' allocation
+        return true;
+    }
+
     void showDetails() const override {
-        std::cout << "Mage: " << name << std::endl;
+        std::cout << "Mage: " << name() << std::endl;
     }
 
-private:
-    std::string name;
+    CharacterKind kind() const override {
+        return MageKind;
+    }
 };
 
 // Concrete Prototype: Archer
 class Archer : public Character {
 public:
-    Archer(const std::string& name) : name(name) {}
+    Archer(const std::string& name) : Character(CharacterTraits::make(name, {110, 40, 100, 14, 32, 10, 15, 12, 7, 25})) {}
+    explicit Archer(std::shared_ptr<const CharacterTraits> traits) : Character(std::move(traits)) {}
 
     Character* clone() const override {
         return new Archer(*this);  // Clone the Archer
     }
 
+    Character* cloneInto(void* storage) const override {
+        return new (storage) Archer(*this);
+    }
+
+    bool assignTo(Character& recycled) const override {
+        if (typeid(recycled) != typeid(Archer)) {
+            return false;
+        }
+        static_cast<Archer&>(recycled) = *this;  // Reuses the recycled overrides' allocation
+        return true;
+    }
+
     void showDetails() const override {
-        std::cout << "Archer: " << name << std::endl;
+        std::cout << "Archer: " << name() << std::endl;
+    }
+
+    CharacterKind kind() const override {
+        return ArcherKind;
+    }
+};
+
+// Raw storage large enough for any concrete character
+const std::size_t kCharacterSlotSize = std::max({sizeof(Warrior), sizeof(Mage), sizeof(Archer)});
+
+struct alignas(std::max_align_t) CharacterStorage {
+    unsigned char bytes[kCharacterSlotSize];
+};
+
+// Constructs a character of the given kind in raw storage
+inline Character* constructCharacter(CharacterKind kind, void* storage, std::shared_ptr<const CharacterTraits> traits) {
+    switch (kind) {
+    case WarriorKind:
+        return new (storage) Warrior(std::move(traits));
+    case MageKind:
+        return new (storage) Mage(std::move(traits));
+    case ArcherKind:
+        return new (storage) Archer(std::move(traits));
+    }
+    throw std::runtime_error("unknown character kind " + std::to_string(kind));
+}
+
+// Identifies a pooled character. The generation detects handles used after release.
+struct CharacterHandle {
+    std::uint32_t pool;  // Prototype id
+    std::uint32_t index;
+    std::uint32_t generation;
+};
+
+// Recycles character slots for one prototype type. Released objects stay
+// constructed, so respawning copy-assigns over them and reuses their overrides;
+// once warmed up (or reserved) spawning and releasing never touch the heap.
+class CharacterPool {
+public:
+    CharacterPool() = default;
+    CharacterPool(const CharacterPool&) = delete;
+    CharacterPool& operator=(const CharacterPool&) = delete;
+
+    ~CharacterPool() {
+        for (Slot& slot : slots) {
+            if (slot.object) {
+                slot.object->~Character();
+            }
+        }
+    }
+
+    void reserve(std::size_t count) {
+        while (slots.size() < count) {
+            grow();
+        }
+        free.reserve(slots.size());
+    }
+
+    // Copies the prototype into a free slot and returns its index
+    std::uint32_t acquire(const Character& prototype) {
+        if (free.empty()) {
+            grow();
+        }
+        std::uint32_t index = free.back();
+        free.pop_back();
+
+        Slot& slot = slots[index];
+        if (!slot.object || !prototype.assignTo(*slot.object)) {
+            if (slot.object) {
+                slot.object->~Character();
+            }
+            slot.object = prototype.cloneInto(slot.storage);
+        }
+        slot.live = true;
+        return index;
+    }
+
+    Character* get(std::uint32_t index, std::uint32_t generation) const {
+        if (index >= slots.size() || !slots[index].live || slots[index].generation != generation) {
+            return nullptr;
+        }
+        return slots[index].object;
+    }
+
+    std::uint32_t generation(std::uint32_t index) const {
+        return slots[index].generation;
+    }
+
+    // Returns the slot to the free list; stale handles stop resolving
+    bool release(std::uint32_t index, std::uint32_t generation) {
+        if (!get(index, generation)) {
+            return false;
+        }
+        slots[index].live = false;
+        ++slots[index].generation;
+        free.push_back(index);
+        return true;
     }
 
 private:
-    std::string name;
+    static const std::size_t kBlockSlots = 1024;
+
+    struct Slot {
+        void* storage;
+        Character* object;  // Constructed in storage; null until first use
+        std::uint32_t generation;
+        bool live;
+    };
+
+    void grow() {
+        blocks.emplace_back(new CharacterStorage[kBlockSlots]);
+        slots.reserve(slots.size() + kBlockSlots);
+        free.reserve(slots.size() + kBlockSlots);
+        for (std::size_t i = kBlockSlots; i-- > 0;) {
+            free.push_back(static_cast<std::uint32_t>(slots.size() + i));
+        }
+        for (std::size_t i = 0; i < kBlockSlots; ++i) {
+            slots.push_back({blocks.back()[i].bytes, nullptr, 0, false});
+        }
+    }
+
+    std::vector<std::unique_ptr<CharacterStorage[]>> blocks;
+    std::vector<Slot> slots;
+    std::vector<std::uint32_t> free;
+};
+
+// Structure-of-arrays storage for spawned waves (ECS-style). Per-entity state
+// lives in parallel columns so per-frame systems stream through only the fields
+// they touch; constant stats stay in the shared traits of each archetype.
+struct EntityBatch {
+    std::vector<std::shared_ptr<const CharacterTraits>> archetypes;
+    std::vector<std::uint16_t> archetype;
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<std::int32_t> health;
+    std::vector<std::int32_t> mana;
+    std::vector<std::int32_t> maxMana;
+
+    std::size_t size() const {
+        return archetype.size();
+    }
+
+    std::uint16_t archetypeFor(const std::shared_ptr<const CharacterTraits>& traits) {
+        for (std::size_t a = 0; a < archetypes.size(); ++a) {
+            if (archetypes[a] == traits) {
+                return static_cast<std::uint16_t>(a);
+            }
+        }
+        if (archetypes.size() > std::numeric_limits<std::uint16_t>::max()) {
+            throw std::length_error("EntityBatch holds at most 65536 archetypes");
+        }
+        archetypes.push_back(traits);
+        return static_cast<std::uint16_t>(archetypes.size() - 1);
+    }
+
+    // Appends count entities at (spawnX, spawnY) copied from the prototype
+    void append(const Character& prototype, std::size_t count, float spawnX, float spawnY) {
+        std::size_t n = size() + count;
+        archetype.resize(n, archetypeFor(prototype.sharedTraits()));
+        x.resize(n, spawnX);
+        y.resize(n, spawnY);
+        vx.resize(n, static_cast<float>(prototype.stat(Speed)));
+        vy.resize(n, 0.0f);
+        health.resize(n, prototype.stat(Health));
+        mana.resize(n, prototype.stat(Mana));
+        maxMana.resize(n, prototype.stat(Mana));
+    }
+
+    // One simulation step: movement and mana regeneration (manaRegen >= 0),
+    // capped at each entity's spawn mana
+    void update(float dt, std::int32_t manaRegen) {
+        std::size_t n = size();
+        float* px = x.data();
+        float* py = y.data();
+        const float* pvx = vx.data();
+        const float* pvy = vy.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            px[i] += pvx[i] * dt;
+            py[i] += pvy[i] * dt;
+        }
+        std::int32_t* pm = mana.data();
+        const std::int32_t* pmax = maxMana.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            pm[i] = std::min(pm[i], pmax[i] - manaRegen) + manaRegen;  // Never exceeds the cap, so never overflows
+        }
+    }
+};
+
+// Interned prototype key: resolve a type name once, then spawn by id
+using PrototypeId = std::uint32_t;
+
+// Epoch-based reclamation for read-mostly data. Readers publish the global
+// epoch they entered under; a writer retires replaced data with the epoch at
+// which it was unlinked and frees it once no reader is still inside an older
+// epoch. Entering and leaving are a few atomic stores, never a lock.
+class EpochDomain {
+private:
+    static const std::size_t kMaxReaders = 256;
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{0};  // 0 when the thread is outside any guard
+        std::atomic<bool> claimed{false};
+    };
+
+    // A thread's slot, claimed on first use and handed back at thread exit
+    struct Reader {
+        Slot* slot = nullptr;
+        int depth = 0;
+
+        ~Reader() {
+            if (slot) {
+                slot->claimed.store(false);
+            }
+        }
+    };
+
+public:
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // Pins the current epoch for the calling thread while in scope; nests
+    class Guard {
+    public:
+        Guard() : reader(EpochDomain::instance().localReader()) {
+            if (reader.depth++ == 0) {
+                reader.slot->epoch.store(EpochDomain::instance().epoch.load());
+            }
+        }
+
+        ~Guard() {
+            if (--reader.depth == 0) {
+                reader.slot->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        Reader& reader;
+    };
+
+    // Starts a new epoch; returns the epoch under which earlier readers may still run
+    std::uint64_t advance() {
+        return epoch.fetch_add(1);
+    }
+
+    // True once no reader can still see data retired at retiredEpoch
+    bool quiescent(std::uint64_t retiredEpoch) const {
+        for (const Slot& slot : slots) {
+            std::uint64_t entered = slot.epoch.load();
+            if (entered != 0 && entered <= retiredEpoch) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    Reader& localReader() {
+        thread_local Reader reader;
+        if (!reader.slot) {
+            for (Slot& candidate : slots) {
+                bool expected = false;
+                if (candidate.claimed.compare_exchange_strong(expected, true)) {
+                    reader.slot = &candidate;
+                    return reader;
+                }
+            }
+            throw std::runtime_error("too many concurrent reader threads");
+        }
+        return reader;
+    }
+
+    std::atomic<std::uint64_t> epoch{1};
+    Slot slots[kMaxReaders];
+};
+
+// Binary prototype catalog: a header, fixed-size records, then the perfect
+// hash (bucket seeds and slot table) over the records' type names. Records are
+// laid out so a mapped file can be used in place. Gear is not stored.
+const char kCatalogMagic[8] = {'C', 'H', 'A', 'R', 'C', 'A', 'T', '\0'};
+const std::uint32_t kCatalogVersion = 1;
+
+struct CatalogHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t count;
+    std::uint32_t buckets;
+    std::uint32_t tableSize;
+};
+
+struct CatalogRecord {
+    char type[32];
+    std::uint32_t kind;  // CharacterKind
+    CharacterTraits traits;
+};
+
+// A catalog file mapped read-only; validated once on load
+class CatalogMapping {
+public:
+    explicit CatalogMapping(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open catalog " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(CatalogHeader)) {
+            ::close(fd);
+            throw std::runtime_error("catalog " + path + " is truncated");
+        }
+        size = static_cast<std::size_t>(info.st_size);
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("cannot map catalog " + path);
+        }
+
+        const CatalogHeader& h = header();
+        bool valid = std::equal(h.magic, h.magic + sizeof(h.magic), kCatalogMagic) && h.version == kCatalogVersion &&
+                     h.buckets > 0 && (h.buckets & (h.buckets - 1)) == 0 && h.tableSize > 0 &&
+                     (h.tableSize & (h.tableSize - 1)) == 0 &&
+                     size == sizeof(CatalogHeader) + std::size_t(h.count) * sizeof(CatalogRecord) +
+                                 (std::size_t(h.buckets) + h.tableSize) * sizeof(std::uint32_t);
+        for (std::uint32_t i = 0; valid && i < h.count; ++i) {
+            valid = records()[i].type[sizeof(records()[i].type) - 1] == '\0' &&
+                    records()[i].traits.name[sizeof(records()[i].traits.name) - 1] == '\0' &&
+                    records()[i].kind <= ArcherKind;
+        }
+        for (std::uint32_t i = 0; valid && i < h.tableSize; ++i) {
+            valid = table()[i] <= h.count;
+        }
+        if (!valid) {
+            ::munmap(data, size);
+            throw std::runtime_error("catalog " + path + " is corrupt or from another version");
+        }
+    }
+
+    CatalogMapping(const CatalogMapping&) = delete;
+    CatalogMapping& operator=(const CatalogMapping&) = delete;
+
+    ~CatalogMapping() {
+        ::munmap(data, size);
+    }
+
+    const CatalogHeader& header() const {
+        return *static_cast<const CatalogHeader*>(data);
+    }
+
+    const CatalogRecord* records() const {
+        return reinterpret_cast<const CatalogRecord*>(static_cast<const char*>(data) + sizeof(CatalogHeader));
+    }
+
+    const std::uint32_t* seeds() const {
+        return reinterpret_cast<const std::uint32_t*>(records() + header().count);
+    }
+
+    const std::uint32_t* table() const {
+        return seeds() + header().buckets;
+    }
+
+private:
+    void* data;
+    std::size_t size;
+};
+
+// Prototype objects for a mapped catalog, built side by side in one block.
+// Their traits alias the mapped records, which keeps the mapping alive.
+class CatalogPrototypes {
+public:
+    explicit CatalogPrototypes(const std::shared_ptr<const CatalogMapping>& mapping)
+        : count(mapping->header().count), storage(new CharacterStorage[count]) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const CatalogRecord& record = mapping->records()[i];
+            constructCharacter(static_cast<CharacterKind>(record.kind), storage[i].bytes,
+                               std::shared_ptr<const CharacterTraits>(mapping, &record.traits));
+        }
+    }
+
+    CatalogPrototypes(const CatalogPrototypes&) = delete;
+    CatalogPrototypes& operator=(const CatalogPrototypes&) = delete;
+
+    ~CatalogPrototypes() {
+        for (std::size_t i = 0; i < count; ++i) {
+            at(i)->~Character();
+        }
+    }
+
+    const Character* at(std::size_t index) const {
+        return reinterpret_cast<const Character*>(storage[index].bytes);
+    }
+
+private:
+    std::size_t count;
+    std::unique_ptr<CharacterStorage[]> storage;
+};
+
+// Everything a spawn needs, published as one immutable unit
+struct RegistrySnapshot {
+    std::unordered_map<std::string, PrototypeId> ids;
+    std::vector<std::string> names;                           // Indexed by id
+    std::vector<std::shared_ptr<const Character>> prototypes;  // Indexed by id
+    bool frozen = false;
+    std::vector<std::uint32_t> seeds;  // Per bucket, chosen by buildPerfectHash()
+    std::vector<std::uint32_t> table;  // Perfect hash slot -> id + 1 (0 = empty)
+
+    bool find(const std::string& type, PrototypeId& id) const {
+        if (frozen) {
+            std::uint32_t seed = seeds[hash(type, 0) & (seeds.size() - 1)];
+            std::uint32_t slot = table[hash(type, seed) & (table.size() - 1)];
+            id = slot - 1;
+            return slot != 0 && names[id] == type;
+        }
+        auto it = ids.find(type);
+        if (it == ids.end()) {
+            return false;
+        }
+        id = it->second;
+        return true;
+    }
+
+    PrototypeId intern(const std::string& type) const {
+        PrototypeId id;
+        if (!find(type, id)) {
+            throw std::out_of_range("unknown prototype type '" + type + "'");
+        }
+        return id;
+    }
+
+    // Builds a perfect hash over the names (hash-and-displace): names are hashed
+    // into small buckets, and each bucket, largest first, searches for a seed
+    // that drops all of its names into free slots. A lookup is then two hashes
+    // and one comparison.
+    void buildPerfectHash() {
+        std::size_t size = 1, buckets = 1;
+        while (size < 2 * names.size()) {
+            size *= 2;
+        }
+        while (buckets < names.size() / 2) {
+            buckets *= 2;
+        }
+        std::vector<std::vector<PrototypeId>> members(buckets);
+        for (PrototypeId id = 0; id < names.size(); ++id) {
+            members[hash(names[id], 0) & (buckets - 1)].push_back(id);
+        }
+        std::vector<std::size_t> order(buckets);
+        for (std::size_t b = 0; b < buckets; ++b) {
+            order[b] = b;
+        }
+        std::sort(order.begin(), order.end(),
+                  [&members](std::size_t a, std::size_t b) { return members[a].size() > members[b].size(); });
+
+        table.assign(size, 0);
+        seeds.assign(buckets, 0);
+        std::vector<std::size_t> slots;
+        for (std::size_t b : order) {
+            for (std::uint32_t seed = 1; !members[b].empty(); ++seed) {
+                slots.clear();
+                for (PrototypeId id : members[b]) {
+                    std::size_t slot = hash(names[id], seed) & (size - 1);
+                    if (table[slot] != 0 || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (slots.size() == members[b].size()) {
+                    for (std::size_t i = 0; i < slots.size(); ++i) {
+                        table[slots[i]] = members[b][i] + 1;
+                    }
+                    seeds[b] = seed;
+                    break;
+                }
+            }
+        }
+    }
+
+    const Character& prototype(PrototypeId id) const {
+        return *prototypes.at(id);
+    }
+
+    // FNV-1a with the seed mixed into the offset basis, then a final avalanche
+    static std::uint32_t hash(const std::string& key, std::uint32_t seed) {
+        std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+        for (unsigned char c : key) {
+            h = (h ^ c) * 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        return h;
+    }
 };
 
 // Prototype Registry
+// Read-mostly and safe to share between threads: readers work on the current
+// snapshot without locking, while writers (serialized by a mutex) publish a
+// modified copy. Replaced snapshots, and the prototypes only they referenced,
+// are freed once every reader that could see them has left.
 class CharacterRegistry {
 public:
-    void addPrototype(const std::string& type, Character* prototype) {
-        prototypes[type] = prototype;
+    CharacterRegistry() : current(new RegistrySnapshot) {}
+    CharacterRegistry(const CharacterRegistry&) = delete;
+    CharacterRegistry& operator=(const CharacterRegistry&) = delete;
+
+    ~CharacterRegistry() {
+        delete current.load();
+        for (auto& entry : retired) {
+            delete entry.second;
+        }
     }
 
-    Character* getPrototype(const std::string& type) const {
-        return prototypes.at(type)->clone();  // Return a clone of the prototype
+    // Registers or hot-patches a prototype, taking ownership of it; returns its id
+    PrototypeId addPrototype(const std::string& type, Character* prototype) {
+        std::shared_ptr<const Character> owned(prototype);
+        std::lock_guard<std::mutex> lock(writer);
+        std::unique_ptr<RegistrySnapshot> next(new RegistrySnapshot(*current.load()));
+        PrototypeId id;
+        if (!next->find(type, id)) {
+            if (next->frozen) {
+                throw std::logic_error("cannot add prototype type '" + type + "' to a frozen registry");
+            }
+            id = static_cast<PrototypeId>(next->prototypes.size());
+            next->ids.emplace(type, id);
+            next->names.push_back(type);
+            next->prototypes.push_back(nullptr);
+        }
+        next->prototypes[id] = std::move(owned);
+        publish(std::move(next));
+        return id;
     }
 
-    ~CharacterRegistry() {
-        for (auto& pair : prototypes) {
-            delete pair.second;
+    // Resolves a type name to its id; throws std::out_of_range for unknown types
+    PrototypeId intern(const std::string& type) const {
+        EpochDomain::Guard guard;
+        return current.load()->intern(type);
+    }
+
+    // Seals the set of types; name lookups then go through a perfect hash
+    void freeze() {
+        std::lock_guard<std::mutex> lock(writer);
+        std::unique_ptr<RegistrySnapshot> next(new RegistrySnapshot(*current.load()));
+        next->buildPerfectHash();
+        next->frozen = true;
+        publish(std::move(next));
+    }
+
+    // Writes every prototype, with its overrides applied, to a binary catalog
+    void writeCatalog(const std::string& path) const {
+        EpochDomain::Guard guard;
+        const RegistrySnapshot* snapshot = current.load();
+        RegistrySnapshot hashed;
+        hashed.names = snapshot->names;
+        hashed.buildPerfectHash();
+
+        CatalogHeader header = {};
+        std::copy(kCatalogMagic, kCatalogMagic + sizeof(header.magic), header.magic);
+        header.version = kCatalogVersion;
+        header.count = static_cast<std::uint32_t>(snapshot->names.size());
+        header.buckets = static_cast<std::uint32_t>(hashed.seeds.size());
+        header.tableSize = static_cast<std::uint32_t>(hashed.table.size());
+
+        std::vector<CatalogRecord> records(header.count);
+        for (PrototypeId id = 0; id < header.count; ++id) {
+            if (snapshot->names[id].size() >= sizeof(records[id].type)) {
+                throw std::invalid_argument("prototype type '" + snapshot->names[id] + "' is too long for a catalog");
+            }
+            std::fill(records[id].type, records[id].type + sizeof(records[id].type), '\0');
+            std::copy(snapshot->names[id].begin(), snapshot->names[id].end(), records[id].type);
+            records[id].kind = snapshot->prototypes[id]->kind();
+            records[id].traits = snapshot->prototypes[id]->effectiveTraits();
         }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CatalogRecord));
+        out.write(reinterpret_cast<const char*>(hashed.seeds.data()), hashed.seeds.size() * sizeof(std::uint32_t));
+        out.write(reinterpret_cast<const char*>(hashed.table.data()), hashed.table.size() * sizeof(std::uint32_t));
+        if (!out) {
+            throw std::runtime_error("cannot write catalog " + path);
+        }
+    }
+
+    // Replaces every prototype with those of a catalog. The file is mapped and
+    // its records serve as the prototypes' traits in place; the prototype
+    // objects are built in one block and the stored perfect hash is reused, so
+    // loading does no per-template parsing or allocation beyond the type names.
+    void loadCatalog(const std::string& path) {
+        std::shared_ptr<const CatalogMapping> mapping(new CatalogMapping(path));
+        std::shared_ptr<const CatalogPrototypes> objects(new CatalogPrototypes(mapping));
+        const CatalogHeader& header = mapping->header();
+
+        std::unique_ptr<RegistrySnapshot> next(new RegistrySnapshot);
+        next->names.reserve(header.count);
+        next->prototypes.reserve(header.count);
+        for (PrototypeId id = 0; id < header.count; ++id) {
+            next->names.emplace_back(mapping->records()[id].type);
+            next->prototypes.emplace_back(objects, objects->at(id));
+        }
+        next->seeds.assign(mapping->seeds(), mapping->seeds() + header.buckets);
+        next->table.assign(mapping->table(), mapping->table() + header.tableSize);
+        next->frozen = true;
+
+        std::lock_guard<std::mutex> lock(writer);
+        publish(std::move(next));
+    }
+
+    Character* getPrototype(PrototypeId id) const {
+        EpochDomain::Guard guard;
+        return current.load()->prototype(id).clone();  // Return a clone of the prototype
+    }
+
+    Character* getPrototype(const std::string& type) const {
+        EpochDomain::Guard guard;
+        const RegistrySnapshot* snapshot = current.load();
+        return snapshot->prototype(snapshot->intern(type)).clone();
+    }
+
+    // Calls visit with the current prototype for id; the prototype stays valid during the call
+    template <typename Visit>
+    void withPrototype(PrototypeId id, Visit visit) const {
+        EpochDomain::Guard guard;
+        visit(current.load()->prototype(id));
+    }
+
+    // Spawns a whole wave into contiguous columns; returns the first new entity's index
+    std::size_t cloneBatch(PrototypeId id, std::size_t count, EntityBatch& batch, float x = 0, float y = 0) const {
+        std::size_t first = batch.size();
+        withPrototype(id, [&](const Character& prototype) { batch.append(prototype, count, x, y); });
+        return first;
+    }
+
+    std::size_t cloneBatch(const std::string& type, std::size_t count, EntityBatch& batch, float x = 0, float y = 0) const {
+        return cloneBatch(intern(type), count, batch, x, y);
+    }
+
+private:
+    // Swaps in the next snapshot and frees retired ones no reader can still see
+    void publish(std::unique_ptr<RegistrySnapshot> next) {
+        const RegistrySnapshot* previous = current.exchange(next.release());
+        retired.emplace_back(EpochDomain::instance().advance(), previous);
+        auto alive = std::remove_if(retired.begin(), retired.end(), [](const std::pair<std::uint64_t, const RegistrySnapshot*>& entry) {
+            if (!EpochDomain::instance().quiescent(entry.first)) {
+                return false;
+            }
+            delete entry.second;
+            return true;
+        });
+        retired.erase(alive, retired.end());
+    }
+
+    std::atomic<const RegistrySnapshot*> current;
+    std::mutex writer;
+    std::vector<std::pair<std::uint64_t, const RegistrySnapshot*>> retired;  // Guarded by writer
+};
+
+// Per-thread spawner recycling clones in per-type pools. Each spawning thread
+// owns one, so pooled spawns need no synchronization beyond the registry's
+// lock-free snapshot read.
+class CharacterSpawner {
+public:
+    explicit CharacterSpawner(const CharacterRegistry& registry) : registry(registry) {}
+
+    // Pooled alternative to getPrototype: the clone lives in a recycled slot
+    // owned by the spawner and must be returned with release()
+    CharacterHandle spawn(PrototypeId id) {
+        CharacterPool& pool = poolFor(id);
+        std::uint32_t index = 0;
+        registry.withPrototype(id, [&](const Character& prototype) { index = pool.acquire(prototype); });
+        return {id, index, pool.generation(index)};
+    }
+
+    CharacterHandle spawn(const std::string& type) {
+        return spawn(registry.intern(type));
+    }
+
+    Character* get(CharacterHandle handle) const {
+        return handle.pool < pools.size() && pools[handle.pool] ? pools[handle.pool]->get(handle.index, handle.generation)
+                                                                 : nullptr;
+    }
+
+    bool release(CharacterHandle handle) {
+        return handle.pool < pools.size() && pools[handle.pool] && pools[handle.pool]->release(handle.index, handle.generation);
+    }
+
+    // Pre-sizes a type's pool so even the first spawns do not allocate
+    void reservePool(PrototypeId id, std::size_t count) {
+        poolFor(id).reserve(count);
     }
 
 private:
-    std::unordered_map<std::string, Character*> prototypes;
+    CharacterPool& poolFor(PrototypeId id) {
+        if (id >= pools.size()) {
+            pools.resize(id + 1);
+        }
+        if (!pools[id]) {
+            pools[id].reset(new CharacterPool);
+        }
+        return *pools[id];
+    }
+
+    const CharacterRegistry& registry;
+    std::vector<std::unique_ptr<CharacterPool>> pools;  // Indexed by prototype id
 };
 
 // Client Code
@@ -124,5 +1131,180 @@ int main() {
     delete warrior2;
     delete mage2;
 
+    // Spawn from the pool: the clone is constructed in a recycled slot
+    CharacterSpawner spawner(registry);
+    CharacterHandle archer2 = spawner.spawn("archer");
+    spawner.get(archer2)->showDetails();  // Archer: Legolas
+    spawner.release(archer2);
+    std::cout << "Released handle resolves: " << (spawner.get(archer2) ? "yes" : "no") << std::endl;
+
+    // Spawn and despawn waves of NPCs, with and without pooling
+    const std::size_t kWave = 10000, kWaves = 100;
+    std::vector<Character*> npcs(kWave);
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t wave = 0; wave < kWaves; ++wave) {
+        for (Character*& npc : npcs) {
+            npc = registry.getPrototype("warrior");
+        }
+        for (Character* npc : npcs) {
+            delete npc;
+        }
+    }
+    double cloneNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+    PrototypeId warriorId = registry.intern("warrior");  // Resolved once, outside the spawn loop
+    spawner.reservePool(warriorId, kWave);
+    std::vector<CharacterHandle> handles(kWave);
+    begin = std::chrono::steady_clock::now();
+    for (std::size_t wave = 0; wave < kWaves; ++wave) {
+        for (CharacterHandle& handle : handles) {
+            handle = spawner.spawn(warriorId);
+        }
+        for (CharacterHandle handle : handles) {
+            spawner.release(handle);
+        }
+    }
+    double poolNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Spawn + release: " << cloneNs / (kWave * kWaves) << " ns with new/delete, "
+              << poolNs / (kWave * kWaves) << " ns pooled" << std::endl;
+
+    // Freeze the set of types: name lookups go through a perfect hash table
+    registry.freeze();
+    std::cout << "Frozen registry resolves 'mage' to id " << registry.intern("mage") << std::endl;
+
+    // Copy-on-write: clones share their prototype's traits until they diverge
+    const std::size_t kWorld = 100000;
+    std::vector<CharacterHandle> world(kWorld);
+    std::size_t ownedBytes = 0, eagerBytes = 0;
+    for (std::size_t i = 0; i < kWorld; ++i) {
+        world[i] = spawner.spawn(i % 2 ? "mage" : "archer");
+        if (i % 100 == 0) {
+            spawner.get(world[i])->setStat(Health, 1);  // A few wounded NPCs
+        }
+    }
+    for (CharacterHandle handle : world) {
+        const Character* npc = spawner.get(handle);
+        ownedBytes += npc->ownedBytes();
+        // What the same NPC would own if cloning deep-copied its traits and gear
+        eagerBytes += sizeof(CharacterTraits) + (npc->equipment() ? npc->equipment()->memoryBytes() : 0);
+    }
+    Character* wounded = spawner.get(world[0]);
+    std::cout << "Wounded " << wounded->name() << " has " << wounded->stat(Health) << " health, prototype has "
+              << spawner.get(world[2])->stat(Health) << std::endl;
+    std::cout << "Per-NPC memory: " << kCharacterSlotSize + static_cast<double>(ownedBytes) / kWorld
+              << " bytes copy-on-write vs " << kCharacterSlotSize + static_cast<double>(eagerBytes) / kWorld
+              << " bytes deep-copying traits and gear" << std::endl;
+
+    // Spawn a wave straight into structure-of-arrays storage and simulate it
+    EntityBatch wave;
+    begin = std::chrono::steady_clock::now();
+    registry.cloneBatch("warrior", 50000, wave);
+    registry.cloneBatch("archer", 50000, wave, 100, 0);
+    double spawnMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    const int kFrames = 100;
+    begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < kFrames; ++frame) {
+        wave.update(1.0f / 60, 1);
+    }
+    double frameNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Batch-spawned " << wave.size() << " entities in " << spawnMs << " ms; update "
+              << frameNs / (kFrames * wave.size()) << " ns per entity per frame (first at x=" << wave.x[0] << ")"
+              << std::endl;
+
+    // Hot-patch the warrior prototype while spawn threads keep cloning it
+    std::atomic<bool> patching(true);
+    std::atomic<std::size_t> spawned(0);
+    std::vector<std::thread> spawners;
+    for (int t = 0; t < 4; ++t) {
+        spawners.emplace_back([&] {
+            CharacterSpawner local(registry);
+            while (patching) {
+                local.release(local.spawn(warriorId));
+                ++spawned;
+            }
+        });
+    }
+    for (int version = 1; version <= 1000; ++version) {
+        Warrior* patched = new Warrior("Conan");
+        patched->setStat(Strength, 30 + version);
+        registry.addPrototype("warrior", patched);  // The replaced prototype is reclaimed safely
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    patching = false;
+    for (std::thread& thread : spawners) {
+        thread.join();
+    }
+    Character* latest = registry.getPrototype(warriorId);
+    std::cout << "Spawned " << spawned << " warriors during 1000 hot patches; strength is now "
+              << latest->stat(Strength) << std::endl;
+    delete latest;
+
+    // Ship thousands of templates as a binary catalog and map it at startup
+    CharacterRegistry designer;
+    for (int i = 0; i < 2000; ++i) {
+        std::string name = "Template " + std::to_string(i);
+        Character* prototype = i % 3 == 0 ? static_cast<Character*>(new Warrior(name))
+                             : i % 3 == 1 ? static_cast<Character*>(new Mage(name))
+                                          : static_cast<Character*>(new Archer(name));
+        prototype->setStat(Health, 50 + i % 200);
+        designer.addPrototype("npc-" + std::to_string(i), prototype);
+    }
+    designer.writeCatalog("characters.catalog");
+
+    CharacterRegistry server;
+    begin = std::chrono::steady_clock::now();
+    server.loadCatalog("characters.catalog");
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    Character* npc = server.getPrototype("npc-1234");
+    std::cout << "Loaded 2000 templates from the catalog in " << loadMs << " ms; npc-1234 is ";
+    npc->showDetails();
+    delete npc;
+    std::remove("characters.catalog");
+
+    // Deep-clone a prototype carrying a 1000-node gear graph: nested bags of
+    // items with one shared charm, and a skill tree with a prerequisite cycle
+    std::vector<GearGraph::Spec> specs;
+    specs.push_back({GearNode::Item, "Backpack", 2, {}});
+    specs.push_back({GearNode::Item, "Lucky charm", 1, {}});
+    for (std::uint32_t i = 2; i < 400; ++i) {
+        specs.push_back({GearNode::Item, "Item " + std::to_string(i), static_cast<std::int32_t>(i % 7 + 1), {}});
+        specs[i < 6 ? 0 : (i - 2) / 4 + 1].links.push_back(i);  // Bags hold four items each
+    }
+    specs[10].links.push_back(1);
+    specs[20].links.push_back(1);
+    specs[0].links.push_back(400);
+    for (std::uint32_t i = 400; i < 1000; ++i) {
+        specs.push_back({GearNode::Skill, "Skill " + std::to_string(i), static_cast<std::int32_t>(i % 5), {}});
+        if (i > 400) {
+            specs[400 + (i - 401) / 2].links.push_back(i);  // Each skill unlocks two more
+        }
+    }
+    specs[999].links.push_back(400);  // A leaf skill reinforces the root: a cycle
+
+    CharacterRegistry armory;
+    Warrior* champion = new Warrior("Champion");
+    champion->equip(std::make_shared<GearGraph>(specs, 0));
+    PrototypeId championId = armory.addPrototype("champion", champion);
+
+    Character* veteran = armory.getPrototype(championId);
+    const std::size_t kDeepClones = 2000;
+    std::size_t copiedNodes = 0;
+    begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kDeepClones; ++i) {
+        Character* copy = veteran->cloneDeep();
+        copiedNodes += copy->equipment()->size();
+        delete copy;
+    }
+    double cloneUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Deep-cloned a " << copiedNodes / kDeepClones << "-node gear graph in " << cloneUs / kDeepClones
+              << " us" << std::endl;
+
+    veteran->mutableEquipment()->root()->value = 5;  // Copy-on-write: the prototype keeps its gear
+    armory.withPrototype(championId, [&](const Character& prototype) {
+        std::cout << "Veteran's backpack weighs " << veteran->equipment()->root()->value << ", the prototype's "
+                  << prototype.equipment()->root()->value << std::endl;
+    });
+    delete veteran;
+
     return 0;
 }
@@ -1,85 +1,2465 @@
-/* 
-   The Strategy Pattern defines a family of algorithms, encapsulates each one, and makes them interchangeable. 
+/*
+   The Strategy Pattern defines a family of algorithms, encapsulates each one, and makes them interchangeable.
    This allows the algorithm to vary independently from the clients that use it.
 
    Real-World Example:
-   Consider a navigation system that offers multiple route strategies like driving, walking, or cycling. 
+   Consider a navigation system that offers multiple route strategies like driving, walking, or cycling.
    Depending on user preferences or context, the app can switch strategies at runtime to find the best path.
    The Strategy Pattern enables this flexibility by allowing the route calculation algorithm to be selected and changed dynamically.
+
+   Strategies are stateless and immutable, so a single Navigator can be shared by many request threads.
+   All per-query scratch memory lives in a thread-local SearchWorkspace that is reused between queries.
 */
 
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using NodeId = std::uint32_t;
+using Seconds = std::uint32_t;
+
+const Seconds kUnreachable = std::numeric_limits<Seconds>::max();
+const NodeId kNoNode = std::numeric_limits<NodeId>::max();
+
+// Travel modes allowed on a road, combined as a bit mask
+enum TravelMode : std::uint8_t {
+    Driving = 1,
+    Walking = 2,
+    Cycling = 4,
+    AllModes = Driving | Walking | Cycling
+};
+
+struct Coordinate {
+    double lat;
+    double lon;
+};
+
+// Road network shared read-only by every strategy (adjacency array layout)
+class RoadGraph {
+public:
+    struct Arc {
+        NodeId head;
+        std::uint32_t lengthMeters;
+        std::uint16_t speedKmh;
+        std::uint8_t modes;
+    };
+
+    NodeId addNode(const std::string& name) {
+        auto it = nodeIds.find(name);
+        if (it != nodeIds.end()) {
+            return it->second;
+        }
+        NodeId id = static_cast<NodeId>(names.size());
+        names.push_back(name);
+        locations.push_back({0, 0});
+        nodeIds.emplace(name, id);
+        return id;
+    }
+
+    NodeId addNode(const std::string& name, Coordinate location) {
+        NodeId id = addNode(name);
+        locations[id] = location;
+        return id;
+    }
+
+    void addRoad(const std::string& from, const std::string& to, std::uint32_t lengthMeters,
+                 std::uint16_t speedKmh, std::uint8_t modes, bool twoWay = true) {
+        addRoad(addNode(from), addNode(to), lengthMeters, speedKmh, modes, twoWay);
+    }
+
+    void addRoad(NodeId from, NodeId to, std::uint32_t lengthMeters, std::uint16_t speedKmh,
+                 std::uint8_t modes, bool twoWay = true) {
+        pending.push_back({from, {to, lengthMeters, speedKmh, modes}});
+        if (twoWay) {
+            pending.push_back({to, {from, lengthMeters, speedKmh, modes}});
+        }
+    }
+
+    // Packs the added roads into the adjacency arrays; call once before routing
+    void finalize() {
+        firstOut.assign(names.size() + 1, 0);
+        for (const auto& road : pending) {
+            ++firstOut[road.first + 1];
+        }
+        for (std::size_t v = 0; v < names.size(); ++v) {
+            firstOut[v + 1] += firstOut[v];
+        }
+        arcs.resize(pending.size());
+        std::vector<std::uint32_t> next(firstOut.begin(), firstOut.end() - 1);
+        for (const auto& road : pending) {
+            arcs[next[road.first]++] = road.second;
+        }
+
+        // Incoming arcs, referenced by index into `arcs`, for backward searches
+        firstIn.assign(names.size() + 1, 0);
+        tails.resize(arcs.size());
+        for (NodeId v = 0; v < names.size(); ++v) {
+            for (std::uint32_t a = firstOut[v]; a < firstOut[v + 1]; ++a) {
+                tails[a] = v;
+                ++firstIn[arcs[a].head + 1];
+            }
+        }
+        for (std::size_t v = 0; v < names.size(); ++v) {
+            firstIn[v + 1] += firstIn[v];
+        }
+        inArcs.resize(arcs.size());
+        next.assign(firstIn.begin(), firstIn.end() - 1);
+        for (std::uint32_t a = 0; a < arcs.size(); ++a) {
+            inArcs[next[arcs[a].head]++] = a;
+        }
+        pending.clear();
+        pending.shrink_to_fit();
+    }
+
+    std::size_t nodeCount() const { return names.size(); }
+    std::size_t arcCount() const { return arcs.size(); }
+
+    std::uint32_t firstArc(NodeId v) const { return firstOut[v]; }
+    std::uint32_t endArc(NodeId v) const { return firstOut[v + 1]; }
+    const Arc& arc(std::uint32_t index) const { return arcs[index]; }
+    NodeId tail(std::uint32_t index) const { return tails[index]; }
+
+    std::uint32_t firstInArc(NodeId v) const { return firstIn[v]; }
+    std::uint32_t endInArc(NodeId v) const { return firstIn[v + 1]; }
+    std::uint32_t inArc(std::uint32_t position) const { return inArcs[position]; }
+
+    NodeId nodeId(const std::string& name) const {
+        auto it = nodeIds.find(name);
+        if (it == nodeIds.end()) {
+            throw std::out_of_range("Unknown location: " + name);
+        }
+        return it->second;
+    }
+
+    const std::string& nodeName(NodeId v) const { return names[v]; }
+    Coordinate location(NodeId v) const { return locations[v]; }
+
+private:
+    std::vector<std::string> names;
+    std::vector<Coordinate> locations;
+    std::unordered_map<std::string, NodeId> nodeIds;
+    std::vector<std::pair<NodeId, Arc>> pending;
+    std::vector<std::uint32_t> firstOut;
+    std::vector<Arc> arcs;
+    std::vector<NodeId> tails;
+    std::vector<std::uint32_t> firstIn;
+    std::vector<std::uint32_t> inArcs;
+};
+
+// Monotone priority queue for integer keys; buckets keep their capacity across queries
+class RadixHeap {
+public:
+    void push(Seconds key, NodeId value) {
+        buckets[bucketFor(key)].push_back({key, value});
+        ++count;
+    }
+
+    std::pair<Seconds, NodeId> pop() {
+        if (buckets[0].empty()) {
+            std::size_t i = 1;
+            while (buckets[i].empty()) {
+                ++i;
+            }
+            last = buckets[i][0].first;
+            for (const auto& entry : buckets[i]) {
+                last = std::min(last, entry.first);
+            }
+            for (const auto& entry : buckets[i]) {
+                buckets[bucketFor(entry.first)].push_back(entry);
+            }
+            buckets[i].clear();
+        }
+        auto top = buckets[0].back();
+        buckets[0].pop_back();
+        --count;
+        return top;
+    }
+
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        last = 0;
+        count = 0;
+    }
+
+private:
+    std::size_t bucketFor(Seconds key) const {
+        return key == last ? 0 : 32 - __builtin_clz(key ^ last);
+    }
+
+    std::array<std::vector<std::pair<Seconds, NodeId>>, 33> buckets;
+    Seconds last = 0;
+    std::size_t count = 0;
+};
+
+// Per-thread scratch space for searches. Distances are only valid when their
+// timestamp matches the current query, so starting a query costs O(1).
+class SearchWorkspace {
+public:
+    // Each thread owns two workspaces so bidirectional searches can run both directions
+    static SearchWorkspace& local(std::size_t slot = 0) {
+        thread_local std::array<SearchWorkspace, 2> workspaces;
+        return workspaces[slot];
+    }
+
+    void startQuery(std::size_t nodeCount) {
+        if (stamps.size() < nodeCount) {
+            stamps.resize(nodeCount, 0);
+            distances.resize(nodeCount);
+            parents.resize(nodeCount);
+            vias.resize(nodeCount);
+        }
+        if (++currentStamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            currentStamp = 1;
+        }
+        heap.clear();
+    }
+
+    Seconds distance(NodeId v) const {
+        return stamps[v] == currentStamp ? distances[v] : kUnreachable;
+    }
+
+    NodeId parent(NodeId v) const { return parents[v]; }
+
+    // Overlay level of the shortcut used to reach v (0 for an original arc)
+    std::uint8_t via(NodeId v) const { return vias[v]; }
+
+    void reach(NodeId v, Seconds d, NodeId from, std::uint8_t viaLevel = 0) {
+        stamps[v] = currentStamp;
+        distances[v] = d;
+        parents[v] = from;
+        vias[v] = viaLevel;
+    }
+
+    RadixHeap heap;
+    std::vector<std::pair<NodeId, std::uint8_t>> path;  // Scratch for unpacking overlay paths
+    std::uint64_t settledNodes = 0;                      // Running total, for benchmarks
+
+private:
+    std::vector<std::uint32_t> stamps;
+    std::vector<Seconds> distances;
+    std::vector<NodeId> parents;
+    std::vector<std::uint8_t> vias;
+    std::uint32_t currentStamp = 0;
+};
+
+// Result of a route query; callers may reuse one Route across queries
+struct Route {
+    std::vector<NodeId> nodes;
+    Seconds travelTime = kUnreachable;
+};
+
+// Limits for alternative routes: at most `count` routes, each no longer than
+// maxStretch times the optimum and sharing at most maxOverlap of its travel time
+struct AlternativeOptions {
+    std::size_t count = 3;
+    double maxStretch = 1.3;
+    double maxOverlap = 0.7;
+};
+
+// Admits a candidate route if it is loop-free and the time it shares with all
+// previously admitted routes stays within the overlap cap
+class AlternativeFilter {
+public:
+    AlternativeFilter(Seconds optimal, double maxOverlap) : optimal(optimal), maxOverlap(maxOverlap) {}
+
+    // legs[i] is the travel time from route.nodes[i] to route.nodes[i + 1]
+    bool accept(const Route& route, const std::vector<Seconds>& legs) {
+        visited.clear();
+        for (NodeId v : route.nodes) {
+            if (!visited.insert(v).second) {
+                return false;
+            }
+        }
+        Seconds shared = 0;
+        for (std::size_t i = 0; i < legs.size(); ++i) {
+            if (usedArcs.count(arcKey(route.nodes[i], route.nodes[i + 1]))) {
+                shared += legs[i];
+            }
+        }
+        if (!usedArcs.empty() && shared > maxOverlap * optimal) {
+            return false;
+        }
+        for (std::size_t i = 0; i < legs.size(); ++i) {
+            usedArcs.insert(arcKey(route.nodes[i], route.nodes[i + 1]));
+        }
+        return true;
+    }
+
+private:
+    static std::uint64_t arcKey(NodeId from, NodeId to) {
+        return static_cast<std::uint64_t>(from) << 32 | to;
+    }
+
+    Seconds optimal;
+    double maxOverlap;
+    std::unordered_set<std::uint64_t> usedArcs;
+    std::unordered_set<NodeId> visited;
+};
 
 // Strategy Interface
 class RouteStrategy {
 public:
-    virtual void buildRoute(const std::string& start, const std::string& end) = 0;
+    virtual const char* name() const = 0;
+    virtual TravelMode mode() const = 0;
+    virtual bool buildRoute(NodeId start, NodeId end, Route& route) const = 0;
+
+    // Up to options.count meaningfully different routes, shortest first
+    virtual void alternativeRoutes(NodeId start, NodeId end, const AlternativeOptions& options,
+                                   std::vector<Route>& routes) const = 0;
+
+    // Isochrone: every node reachable from `source` within `limit` seconds
+    virtual void reachableWithin(NodeId source, Seconds limit, std::vector<NodeId>& nodes) const = 0;
+
+    // Bytes held by the strategy's preprocessed data (not counting the shared graph)
+    virtual std::size_t memoryBytes() const = 0;
+
     virtual ~RouteStrategy() {}
 };
 
+// Seconds needed to cover an arc at the given speed (never zero, keeps the search monotone)
+inline Seconds travelSeconds(std::uint32_t lengthMeters, std::uint32_t speedKmh) {
+    return std::max<Seconds>(1, lengthMeters * 36 / (speedKmh * 10));
+}
+
+// Nested multi-level partition of the road graph used by the driving overlay.
+// Level 1 cells are small connected regions; each higher level groups
+// neighbouring cells of the level below. Depends only on topology, never on weights.
+class OverlayPartition {
+public:
+    struct Cell {
+        std::vector<NodeId> boundary;  // Nodes incident to an arc leaving the cell
+        std::size_t matrixOffset = 0;  // Start of this cell's boundary x boundary clique
+    };
+
+    OverlayPartition(const RoadGraph& graph, const std::vector<std::uint32_t>& maxCellNodes) : limits(maxCellNodes) {
+        std::size_t n = graph.nodeCount();
+        std::vector<std::uint32_t> previous(n);
+        for (std::size_t l = 0; l < maxCellNodes.size(); ++l) {
+            std::vector<std::uint32_t> cellOfNode(n);
+            if (l == 0) {
+                std::vector<std::uint32_t> single(n);
+                for (NodeId v = 0; v < n; ++v) {
+                    single[v] = v;
+                }
+                growCells(graph, single, std::vector<std::uint32_t>(n, 1), maxCellNodes[l], cellOfNode);
+            } else {
+                std::vector<std::uint32_t> sizes(levels.back().cells.size(), 0);
+                for (NodeId v = 0; v < n; ++v) {
+                    ++sizes[previous[v]];
+                }
+                growCells(graph, previous, sizes, maxCellNodes[l], cellOfNode);
+            }
+            addLevel(graph, cellOfNode);  // Moves cellOfNode into the level
+            previous = levels.back().cellOf;
+        }
+    }
+
+    std::size_t levelCount() const { return levels.size(); }
+
+    // Levels are numbered from 1 (finest) to levelCount()
+    std::uint32_t cellOf(std::size_t level, NodeId v) const { return levels[level - 1].cellOf[v]; }
+    const Cell& cell(std::size_t level, std::uint32_t c) const { return levels[level - 1].cells[c]; }
+    std::size_t cellCount(std::size_t level) const { return levels[level - 1].cells.size(); }
+    std::size_t matrixSize(std::size_t level) const { return levels[level - 1].matrixSize; }
+    std::uint32_t maxCellNodes(std::size_t level) const { return limits[level - 1]; }
+
+    // Node count of the level's largest cell; never above maxCellNodes(level)
+    std::uint32_t largestCell(std::size_t level) const {
+        std::vector<std::uint32_t> sizes(cellCount(level), 0);
+        for (std::uint32_t c : levels[level - 1].cellOf) {
+            ++sizes[c];
+        }
+        return sizes.empty() ? 0 : *std::max_element(sizes.begin(), sizes.end());
+    }
+
+    // Position of v in its cell's boundary list, or kNoNode if v is interior
+    std::uint32_t boundaryIndex(std::size_t level, NodeId v) const { return levels[level - 1].boundaryIndex[v]; }
+
+    std::size_t memoryBytes() const {
+        std::size_t bytes = 0;
+        for (const Level& level : levels) {
+            bytes += (level.cellOf.size() + level.boundaryIndex.size()) * sizeof(std::uint32_t);
+            for (const Cell& cell : level.cells) {
+                bytes += sizeof(Cell) + cell.boundary.size() * sizeof(NodeId);
+            }
+        }
+        return bytes;
+    }
+
+    // Highest level at which v lies in neither the source's nor the target's cell (0 = search the original arcs)
+    std::size_t queryLevel(NodeId v, NodeId start, NodeId end) const {
+        for (std::size_t l = levels.size(); l >= 1; --l) {
+            std::uint32_t c = cellOf(l, v);
+            if (c != cellOf(l, start) && c != cellOf(l, end)) {
+                return l;
+            }
+        }
+        return 0;
+    }
+
+private:
+    struct Level {
+        std::vector<std::uint32_t> cellOf;
+        std::vector<std::uint32_t> boundaryIndex;
+        std::vector<Cell> cells;
+        std::size_t matrixSize = 0;
+    };
+
+    // Breadth-first region growing over units (nodes or cells of the level below)
+    static void growCells(const RoadGraph& graph, const std::vector<std::uint32_t>& unitOf,
+                          const std::vector<std::uint32_t>& unitSize, std::uint32_t maxNodes,
+                          std::vector<std::uint32_t>& cellOfNode) {
+        std::size_t units = unitSize.size();
+        std::vector<std::vector<std::uint32_t>> neighbours(units);
+        std::vector<std::vector<NodeId>> members(units);
+        for (NodeId v = 0; v < graph.nodeCount(); ++v) {
+            members[unitOf[v]].push_back(v);
+            for (std::uint32_t a = graph.firstArc(v); a < graph.endArc(v); ++a) {
+                std::uint32_t other = unitOf[graph.arc(a).head];
+                if (other != unitOf[v]) {
+                    neighbours[unitOf[v]].push_back(other);
+                    neighbours[other].push_back(unitOf[v]);
+                }
+            }
+        }
+
+        std::vector<std::uint32_t> cellOfUnit(units, kNoNode);
+        std::vector<std::uint32_t> queue;
+        std::uint32_t cells = 0;
+        for (std::uint32_t seed = 0; seed < units; ++seed) {
+            if (cellOfUnit[seed] != kNoNode) {
+                continue;
+            }
+            std::uint32_t size = unitSize[seed];  // Nodes in the cell so far
+            queue.assign(1, seed);
+            cellOfUnit[seed] = cells;
+            for (std::size_t head = 0; head < queue.size(); ++head) {
+                for (std::uint32_t next : neighbours[queue[head]]) {
+                    if (cellOfUnit[next] == kNoNode && size + unitSize[next] <= maxNodes) {
+                        cellOfUnit[next] = cells;
+                        size += unitSize[next];
+                        queue.push_back(next);
+                    }
+                }
+            }
+            ++cells;
+        }
+        for (std::uint32_t u = 0; u < units; ++u) {
+            for (NodeId v : members[u]) {
+                cellOfNode[v] = cellOfUnit[u];
+            }
+        }
+    }
+
+    void addLevel(const RoadGraph& graph, std::vector<std::uint32_t>& cellOfNode) {
+        Level level;
+        level.cellOf = std::move(cellOfNode);
+        level.boundaryIndex.assign(graph.nodeCount(), kNoNode);
+        std::uint32_t cells = 0;
+        for (std::uint32_t c : level.cellOf) {
+            cells = std::max(cells, c + 1);
+        }
+        level.cells.resize(cells);
+
+        auto markBoundary = [&level](NodeId v) {
+            if (level.boundaryIndex[v] == kNoNode) {
+                Cell& cell = level.cells[level.cellOf[v]];
+                level.boundaryIndex[v] = static_cast<std::uint32_t>(cell.boundary.size());
+                cell.boundary.push_back(v);
+            }
+        };
+        for (NodeId v = 0; v < graph.nodeCount(); ++v) {
+            for (std::uint32_t a = graph.firstArc(v); a < graph.endArc(v); ++a) {
+                NodeId w = graph.arc(a).head;
+                if (level.cellOf[v] != level.cellOf[w]) {
+                    markBoundary(v);
+                    markBoundary(w);
+                }
+            }
+        }
+        for (Cell& cell : level.cells) {
+            cell.matrixOffset = level.matrixSize;
+            level.matrixSize += cell.boundary.size() * cell.boundary.size();
+        }
+        levels.push_back(std::move(level));
+    }
+
+    std::vector<std::uint32_t> limits;  // maxCellNodes per level
+    std::vector<Level> levels;
+};
+
+// Live driving speed for one road segment; 0 km/h closes the road
+struct TrafficUpdate {
+    NodeId from;
+    NodeId to;
+    std::uint16_t speedKmh;
+};
+
 // Concrete Strategy - Driving
+// Customizable route planning: arc weights and overlay cliques form a metric
+// snapshot that is rebuilt off to the side and published atomically, so
+// in-flight queries keep routing on the snapshot they started with.
 class DrivingStrategy : public RouteStrategy {
 public:
-    void buildRoute(const std::string& start, const std::string& end) override {
-        std::cout << "Calculating driving route from " << start << " to " << end << std::endl;
+    explicit DrivingStrategy(std::shared_ptr<const RoadGraph> graph,
+                             const std::vector<std::uint32_t>& maxCellNodes = {64, 1024, 16384})
+        : graph(std::move(graph)), partition(*this->graph, maxCellNodes) {
+        auto metric = std::make_shared<Metric>();
+        metric->arcWeights.resize(this->graph->arcCount());
+        for (NodeId v = 0; v < this->graph->nodeCount(); ++v) {
+            for (std::uint32_t a = this->graph->firstArc(v); a < this->graph->endArc(v); ++a) {
+                const RoadGraph::Arc& arc = this->graph->arc(a);
+                metric->arcWeights[a] = (arc.modes & Driving) ? travelSeconds(arc.lengthMeters, arc.speedKmh)
+                                                              : kUnreachable;
+            }
+        }
+        metric->cliques.resize(partition.levelCount());
+        std::vector<std::vector<std::uint32_t>> dirty(partition.levelCount());
+        for (std::size_t l = 1; l <= partition.levelCount(); ++l) {
+            metric->cliques[l - 1].resize(partition.matrixSize(l));
+            for (std::uint32_t c = 0; c < partition.cellCount(l); ++c) {
+                dirty[l - 1].push_back(c);
+            }
+        }
+        customize(*metric, dirty);
+        current = std::move(metric);
+    }
+
+    const char* name() const override { return "driving"; }
+    TravelMode mode() const override { return Driving; }
+
+    bool buildRoute(NodeId start, NodeId end, Route& route) const override {
+        std::shared_ptr<const Metric> metric = std::atomic_load(&current);
+        SearchWorkspace& ws = SearchWorkspace::local();
+        ws.startQuery(graph->nodeCount());
+        ws.reach(start, 0, kNoNode);
+        ws.heap.push(0, start);
+
+        while (!ws.heap.empty()) {
+            auto top = ws.heap.pop();
+            NodeId v = top.second;
+            if (top.first != ws.distance(v)) {
+                continue;  // Stale heap entry
+            }
+            ++ws.settledNodes;
+            if (v == end) {
+                break;
+            }
+            std::size_t level = partition.queryLevel(v, start, end);
+            if (level > 0) {
+                // Jump across the cell via its precomputed boundary clique
+                const OverlayPartition::Cell& cell = partition.cell(level, partition.cellOf(level, v));
+                std::size_t b = cell.boundary.size();
+                const Seconds* row = metric->cliques[level - 1].data() + cell.matrixOffset + partition.boundaryIndex(level, v) * b;
+                for (std::size_t j = 0; j < b; ++j) {
+                    relax(ws, v, cell.boundary[j], top.first, row[j], static_cast<std::uint8_t>(level));
+                }
+            }
+            for (std::uint32_t a = graph->firstArc(v); a < graph->endArc(v); ++a) {
+                NodeId w = graph->arc(a).head;
+                if (level == 0 || partition.cellOf(level, w) != partition.cellOf(level, v)) {
+                    relax(ws, v, w, top.first, metric->arcWeights[a], 0);
+                }
+            }
+        }
+
+        route.nodes.clear();
+        route.travelTime = ws.distance(end);
+        if (route.travelTime == kUnreachable) {
+            return false;
+        }
+        ws.path.clear();
+        for (NodeId v = end; v != kNoNode; v = ws.parent(v)) {
+            ws.path.push_back({v, ws.via(v)});
+        }
+        std::reverse(ws.path.begin(), ws.path.end());
+
+        // Replace every clique shortcut with the in-cell path it stands for
+        route.nodes.push_back(start);
+        for (std::size_t i = 1; i < ws.path.size(); ++i) {
+            if (ws.path[i].second == 0) {
+                route.nodes.push_back(ws.path[i].first);
+            } else {
+                appendCellPath(*metric, ws.path[i].second, ws.path[i - 1].first, ws.path[i].first, route);
+            }
+        }
+        return true;
+    }
+
+    // Plateau alternatives: a forward shortest-path tree from the start and a
+    // backward tree from the end; paths shared by both trees (plateaus) yield
+    // routes start -> plateau -> end, preferred by plateau length
+    void alternativeRoutes(NodeId start, NodeId end, const AlternativeOptions& options,
+                           std::vector<Route>& routes) const override {
+        std::shared_ptr<const Metric> metric = std::atomic_load(&current);
+        SearchWorkspace& fwd = SearchWorkspace::local(0);
+        SearchWorkspace& bwd = SearchWorkspace::local(1);
+        routes.clear();
+        if (options.count == 0) {
+            return;  // Like the CH strategies, which check the count before adding any route
+        }
+        std::vector<NodeId> forwardTree;
+        Seconds bound = kUnreachable;
+        for (int direction = 0; direction < 2; ++direction) {
+            SearchWorkspace& ws = direction == 0 ? fwd : bwd;
+            NodeId origin = direction == 0 ? start : end;
+            ws.startQuery(graph->nodeCount());
+            ws.reach(origin, 0, kNoNode);
+            ws.heap.push(0, origin);
+            while (!ws.heap.empty()) {
+                auto top = ws.heap.pop();
+                NodeId v = top.second;
+                if (top.first != ws.distance(v)) {
+                    continue;
+                }
+                if (top.first > bound) {
+                    break;
+                }
+                ++ws.settledNodes;
+                if (direction == 0) {
+                    forwardTree.push_back(v);
+                    if (v == end) {
+                        bound = static_cast<Seconds>(options.maxStretch * top.first);
+                    }
+                    for (std::uint32_t a = graph->firstArc(v); a < graph->endArc(v); ++a) {
+                        relax(ws, v, graph->arc(a).head, top.first, metric->arcWeights[a], 0);
+                    }
+                } else {
+                    for (std::uint32_t i = graph->firstInArc(v); i < graph->endInArc(v); ++i) {
+                        std::uint32_t a = graph->inArc(i);
+                        relax(ws, v, graph->tail(a), top.first, metric->arcWeights[a], 0);
+                    }
+                }
+            }
+            if (fwd.distance(end) == kUnreachable) {
+                return;
+            }
+        }
+
+        // Arc parent(w) -> w lies on a plateau when both trees use it
+        auto onPlateau = [&](NodeId w) {
+            NodeId u = fwd.parent(w);
+            return u != kNoNode && bwd.distance(u) != kUnreachable && bwd.parent(u) == w;
+        };
+        std::vector<std::pair<Seconds, NodeId>> plateaus;  // (-length, last node)
+        for (NodeId b : forwardTree) {
+            if (bwd.distance(b) == kUnreachable || !onPlateau(b)) {
+                continue;
+            }
+            NodeId next = bwd.parent(b);
+            if (next != kNoNode && fwd.distance(next) != kUnreachable && fwd.parent(next) == b && onPlateau(next)) {
+                continue;  // Not the end of its plateau
+            }
+            NodeId a = b;
+            while (onPlateau(a)) {
+                a = fwd.parent(a);
+            }
+            if (fwd.distance(b) + bwd.distance(b) <= options.maxStretch * fwd.distance(end)) {
+                plateaus.push_back({kUnreachable - (fwd.distance(b) - fwd.distance(a)), b});
+            }
+        }
+        std::sort(plateaus.begin(), plateaus.end());
+
+        AlternativeFilter filter(fwd.distance(end), options.maxOverlap);
+        Route route;
+        std::vector<Seconds> legs;
+        auto tryVia = [&](NodeId via) {
+            route.nodes.clear();
+            legs.clear();
+            for (NodeId v = via; v != kNoNode; v = fwd.parent(v)) {
+                route.nodes.push_back(v);
+                if (fwd.parent(v) != kNoNode) {
+                    legs.push_back(fwd.distance(v) - fwd.distance(fwd.parent(v)));
+                }
+            }
+            std::reverse(route.nodes.begin(), route.nodes.end());
+            std::reverse(legs.begin(), legs.end());
+            for (NodeId v = via; bwd.parent(v) != kNoNode; v = bwd.parent(v)) {
+                route.nodes.push_back(bwd.parent(v));
+                legs.push_back(bwd.distance(v) - bwd.distance(bwd.parent(v)));
+            }
+            route.travelTime = fwd.distance(via) + bwd.distance(via);
+            if (filter.accept(route, legs)) {
+                routes.push_back(route);
+            }
+        };
+        tryVia(end);  // The optimal route comes first
+        for (const auto& plateau : plateaus) {
+            if (routes.size() == options.count) {
+                break;
+            }
+            tryVia(plateau.second);
+        }
+    }
+
+    // Driving weights change with traffic, so isochrones use a bounded Dijkstra on the live snapshot
+    void reachableWithin(NodeId source, Seconds limit, std::vector<NodeId>& nodes) const override {
+        std::shared_ptr<const Metric> metric = std::atomic_load(&current);
+        SearchWorkspace& ws = SearchWorkspace::local();
+        ws.startQuery(graph->nodeCount());
+        ws.reach(source, 0, kNoNode);
+        ws.heap.push(0, source);
+        nodes.clear();
+        while (!ws.heap.empty()) {
+            auto top = ws.heap.pop();
+            NodeId v = top.second;
+            if (top.first != ws.distance(v)) {
+                continue;
+            }
+            ++ws.settledNodes;
+            nodes.push_back(v);
+            for (std::uint32_t a = graph->firstArc(v); a < graph->endArc(v); ++a) {
+                Seconds weight = metric->arcWeights[a];
+                if (weight != kUnreachable && top.first + weight <= limit) {
+                    relax(ws, v, graph->arc(a).head, top.first, weight, 0);
+                }
+            }
+        }
+    }
+
+    const OverlayPartition& overlay() const { return partition; }
+
+    std::size_t memoryBytes() const override {
+        std::shared_ptr<const Metric> metric = std::atomic_load(&current);
+        std::size_t bytes = partition.memoryBytes() + metric->arcWeights.size() * sizeof(Seconds);
+        for (const auto& cliques : metric->cliques) {
+            bytes += cliques.size() * sizeof(Seconds);
+        }
+        return bytes;
+    }
+
+    // Applies one batch of streamed speed updates and re-customizes only the
+    // cells containing a changed arc. Returns the number of cells rebuilt.
+    std::size_t applyTrafficUpdates(const std::vector<TrafficUpdate>& batch) {
+        for (const TrafficUpdate& update : batch) {
+            if (update.from >= graph->nodeCount() || update.to >= graph->nodeCount()) {
+                throw std::out_of_range("Traffic update for an unknown road");
+            }
+        }
+        std::lock_guard<std::mutex> lock(updateMutex);
+        std::shared_ptr<const Metric> live = std::atomic_load(&current);
+
+        // Double buffering: reuse the retired snapshot once no query holds it
+        std::shared_ptr<Metric> next;
+        if (spare && spare.use_count() == 1) {
+            // use_count is a relaxed load; order the last reader's reads before our writes
+            std::atomic_thread_fence(std::memory_order_acquire);
+            next = std::move(spare);
+            *next = *live;
+        } else {
+            next = std::make_shared<Metric>(*live);
+        }
+
+        std::vector<std::vector<std::uint32_t>> dirty(partition.levelCount());
+        for (const TrafficUpdate& update : batch) {
+            for (std::uint32_t a = graph->firstArc(update.from); a < graph->endArc(update.from); ++a) {
+                const RoadGraph::Arc& arc = graph->arc(a);
+                if (arc.head != update.to || !(arc.modes & Driving)) {
+                    continue;
+                }
+                next->arcWeights[a] = update.speedKmh ? travelSeconds(arc.lengthMeters, update.speedKmh)
+                                                      : kUnreachable;
+                for (std::size_t l = 1; l <= partition.levelCount(); ++l) {
+                    if (partition.cellOf(l, update.from) == partition.cellOf(l, update.to)) {
+                        dirty[l - 1].push_back(partition.cellOf(l, update.from));
+                    }
+                }
+            }
+        }
+
+        std::size_t rebuilt = 0;
+        for (auto& cells : dirty) {
+            std::sort(cells.begin(), cells.end());
+            cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+            rebuilt += cells.size();
+        }
+        customize(*next, dirty);
+
+        std::shared_ptr<const Metric> published = next;
+        std::atomic_store(&current, published);
+        spare = std::const_pointer_cast<Metric>(live);
+        return rebuilt;
+    }
+
+private:
+    struct Metric {
+        std::vector<Seconds> arcWeights;              // Indexed like the graph's arcs
+        std::vector<std::vector<Seconds>> cliques;    // Per level, all cell matrices back to back
+    };
+
+    static void relax(SearchWorkspace& ws, NodeId from, NodeId to, Seconds base, Seconds weight, std::uint8_t via) {
+        if (weight == kUnreachable) {
+            return;
+        }
+        Seconds d = base + weight;
+        if (d < ws.distance(to)) {
+            ws.reach(to, d, from, via);
+            ws.heap.push(d, to);
+        }
+    }
+
+    // Dijkstra confined to one cell: original arcs at level 1, or the cliques
+    // of its sub-cells plus the arcs between them at higher levels
+    void searchCell(const Metric& metric, std::size_t level, NodeId source, NodeId target = kNoNode) const {
+        SearchWorkspace& ws = SearchWorkspace::local();
+        ws.startQuery(graph->nodeCount());
+        ws.reach(source, 0, kNoNode);
+        ws.heap.push(0, source);
+        std::uint32_t cell = partition.cellOf(level, source);
+
+        while (!ws.heap.empty()) {
+            auto top = ws.heap.pop();
+            NodeId v = top.second;
+            if (top.first != ws.distance(v)) {
+                continue;
+            }
+            ++ws.settledNodes;
+            if (v == target) {
+                return;
+            }
+            std::size_t sub = level - 1;
+            if (sub > 0) {
+                const OverlayPartition::Cell& subCell = partition.cell(sub, partition.cellOf(sub, v));
+                std::size_t b = subCell.boundary.size();
+                const Seconds* row = metric.cliques[sub - 1].data() + subCell.matrixOffset + partition.boundaryIndex(sub, v) * b;
+                for (std::size_t j = 0; j < b; ++j) {
+                    relax(ws, v, subCell.boundary[j], top.first, row[j], static_cast<std::uint8_t>(sub));
+                }
+            }
+            for (std::uint32_t a = graph->firstArc(v); a < graph->endArc(v); ++a) {
+                NodeId w = graph->arc(a).head;
+                if (partition.cellOf(level, w) != cell) {
+                    continue;
+                }
+                if (sub == 0 || partition.cellOf(sub, w) != partition.cellOf(sub, v)) {
+                    relax(ws, v, w, top.first, metric.arcWeights[a], 0);
+                }
+            }
+        }
+    }
+
+    // Rebuilds the clique matrices of the given cells, finest level first;
+    // cells of one level are independent and are spread across cores
+    void customize(Metric& metric, const std::vector<std::vector<std::uint32_t>>& dirty) const {
+        for (std::size_t l = 1; l <= partition.levelCount(); ++l) {
+            const std::vector<std::uint32_t>& cells = dirty[l - 1];
+            auto work = [&](std::size_t first, std::size_t stride) {
+                SearchWorkspace& ws = SearchWorkspace::local();
+                for (std::size_t i = first; i < cells.size(); i += stride) {
+                    const OverlayPartition::Cell& cell = partition.cell(l, cells[i]);
+                    std::size_t b = cell.boundary.size();
+                    Seconds* matrix = metric.cliques[l - 1].data() + cell.matrixOffset;  // Levels may have no boundary at all
+                    for (std::size_t from = 0; from < b; ++from) {
+                        searchCell(metric, l, cell.boundary[from]);
+                        for (std::size_t to = 0; to < b; ++to) {
+                            matrix[from * b + to] = ws.distance(cell.boundary[to]);
+                        }
+                    }
+                }
+            };
+
+            std::size_t threads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                        (cells.size() + 7) / 8);
+            std::vector<std::thread> pool;
+            for (std::size_t t = 1; t < threads; ++t) {
+                pool.emplace_back(work, t, threads);
+            }
+            work(0, std::max<std::size_t>(threads, 1));
+            for (auto& thread : pool) {
+                thread.join();
+            }
+        }
+    }
+
+    // Appends the original-arc path behind a clique shortcut (excluding its first node)
+    void appendCellPath(const Metric& metric, std::size_t level, NodeId from, NodeId to, Route& route) const {
+        searchCell(metric, level, from, to);
+        SearchWorkspace& ws = SearchWorkspace::local();
+        std::size_t first = ws.path.size();
+        for (NodeId v = to; v != from; v = ws.parent(v)) {
+            ws.path.push_back({v, ws.via(v)});
+        }
+        std::reverse(ws.path.begin() + first, ws.path.end());
+
+        // Nested shortcuts push their hops past `last` and pop them again, so indices stay valid
+        std::size_t last = ws.path.size();
+        NodeId previous = from;
+        for (std::size_t i = first; i < last; ++i) {
+            NodeId v = ws.path[i].first;
+            if (ws.path[i].second == 0) {
+                route.nodes.push_back(v);
+            } else {
+                appendCellPath(metric, ws.path[i].second, previous, v, route);
+            }
+            previous = v;
+        }
+        ws.path.resize(first);
+    }
+
+    const std::shared_ptr<const RoadGraph> graph;
+    const OverlayPartition partition;
+    std::shared_ptr<const Metric> current;
+    std::shared_ptr<Metric> spare;
+    std::mutex updateMutex;
+};
+
+// Contraction hierarchy for one travel mode with fixed weights. Nodes are
+// renumbered by descending rank so that a PHAST sweep over all nodes is a
+// single linear pass; ids below refer to these positions unless noted.
+class ContractionHierarchy {
+public:
+    template <typename ArcCost>
+    ContractionHierarchy(const RoadGraph& graph, std::uint8_t mode, ArcCost arcCost) {
+        std::size_t n = graph.nodeCount();
+        std::vector<std::vector<DynamicEdge>> out(n), in(n);
+        for (NodeId v = 0; v < n; ++v) {
+            for (std::uint32_t a = graph.firstArc(v); a < graph.endArc(v); ++a) {
+                const RoadGraph::Arc& arc = graph.arc(a);
+                if ((arc.modes & mode) && arc.head != v) {
+                    addEdge(out, in, v, arc.head, arcCost(arc), kNoNode);
+                }
+            }
+        }
+        std::vector<std::pair<NodeId, DynamicEdge>> edges;
+        std::vector<NodeId> order = contract(out, in, edges);
+
+        positionOf.resize(n);
+        nodeAt.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            NodeId p = static_cast<NodeId>(n - 1 - i);
+            positionOf[order[i]] = p;
+            nodeAt[p] = order[i];
+        }
+
+        // Every edge is stored once, at its lower-ranked (higher position) end
+        std::vector<std::vector<UpEdge>> up(n);
+        for (const auto& entry : edges) {
+            const DynamicEdge& e = entry.second;
+            NodeId pu = positionOf[entry.first], px = positionOf[e.other];
+            NodeId mid = e.middle == kNoNode ? kNoNode : positionOf[e.middle];
+            if (pu > px) {
+                up[pu].push_back({px, e.weight, mid, true});
+            } else {
+                up[px].push_back({pu, e.weight, mid, false});
+            }
+        }
+        firstUp.assign(n + 1, 0);
+        for (std::size_t p = 0; p < n; ++p) {
+            firstUp[p + 1] = firstUp[p] + static_cast<std::uint32_t>(up[p].size());
+            upEdges.insert(upEdges.end(), up[p].begin(), up[p].end());
+        }
+    }
+
+    std::size_t nodeCount() const { return nodeAt.size(); }
+
+    // Bidirectional upward search; route nodes are original graph ids
+    bool query(NodeId start, NodeId end, Route& route) const {
+        SearchWorkspace& fwd = SearchWorkspace::local(0);
+        SearchWorkspace& bwd = SearchWorkspace::local(1);
+        NodeId s = positionOf[start], t = positionOf[end];
+        fwd.startQuery(nodeCount());
+        bwd.startQuery(nodeCount());
+        fwd.reach(s, 0, kNoNode);
+        fwd.heap.push(0, s);
+        bwd.reach(t, 0, kNoNode);
+        bwd.heap.push(0, t);
+
+        Seconds best = kUnreachable;
+        NodeId meeting = kNoNode;
+        bool forwardDone = false, backwardDone = false;
+        for (bool forward = true; !(forwardDone && backwardDone); forward = !forward) {
+            SearchWorkspace& ws = forward ? fwd : bwd;
+            SearchWorkspace& other = forward ? bwd : fwd;
+            bool& done = forward ? forwardDone : backwardDone;
+            if (done) {
+                continue;
+            }
+            if (ws.heap.empty()) {
+                done = true;
+                continue;
+            }
+            auto top = ws.heap.pop();
+            NodeId v = top.second;
+            if (top.first != ws.distance(v)) {
+                continue;
+            }
+            ++ws.settledNodes;
+            if (top.first >= best) {
+                done = true;  // Nothing left in this direction can improve the meeting point
+                continue;
+            }
+            if (other.distance(v) != kUnreachable && top.first + other.distance(v) < best) {
+                best = top.first + other.distance(v);
+                meeting = v;
+            }
+            relaxUpward(ws, v, top.first, forward, kUnreachable);
+        }
+
+        route.nodes.clear();
+        route.travelTime = best;
+        if (meeting == kNoNode) {
+            return false;
+        }
+        extractPath(fwd, bwd, meeting, route.nodes, nullptr);
+        return true;
+    }
+
+    // Via-node alternatives: complete upward searches from both ends; every
+    // node reached by both is a candidate via node, tried in order of length
+    void alternatives(NodeId start, NodeId end, const AlternativeOptions& options, std::vector<Route>& routes) const {
+        SearchWorkspace& fwd = SearchWorkspace::local(0);
+        SearchWorkspace& bwd = SearchWorkspace::local(1);
+        routes.clear();
+        std::vector<NodeId> forwardSpace;
+        for (int direction = 0; direction < 2; ++direction) {
+            SearchWorkspace& ws = direction == 0 ? fwd : bwd;
+            NodeId origin = positionOf[direction == 0 ? start : end];
+            ws.startQuery(nodeCount());
+            ws.reach(origin, 0, kNoNode);
+            ws.heap.push(0, origin);
+            while (!ws.heap.empty()) {
+                auto top = ws.heap.pop();
+                if (top.first != ws.distance(top.second)) {
+                    continue;
+                }
+                ++ws.settledNodes;
+                if (direction == 0) {
+                    forwardSpace.push_back(top.second);
+                }
+                relaxUpward(ws, top.second, top.first, direction == 0, kUnreachable);
+            }
+        }
+
+        std::vector<std::pair<Seconds, NodeId>> candidates;
+        for (NodeId v : forwardSpace) {
+            if (bwd.distance(v) != kUnreachable) {
+                candidates.push_back({fwd.distance(v) + bwd.distance(v), v});
+            }
+        }
+        if (candidates.empty()) {
+            return;
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        AlternativeFilter filter(candidates[0].first, options.maxOverlap);
+        Route route;
+        std::vector<Seconds> legs;
+        for (const auto& candidate : candidates) {
+            if (routes.size() == options.count || candidate.first > options.maxStretch * candidates[0].first) {
+                break;
+            }
+            route.nodes.clear();
+            legs.clear();
+            route.travelTime = candidate.first;
+            extractPath(fwd, bwd, candidate.second, route.nodes, &legs);
+            if (filter.accept(route, legs)) {
+                routes.push_back(route);
+            }
+        }
+    }
+
+    // PHAST: upward search from the source, then one top-down sweep over all
+    // nodes. Everything within `limit` is appended to `nodes` (original ids).
+    void reachable(NodeId source, Seconds limit, std::vector<NodeId>& nodes) const {
+        SearchWorkspace& ws = SearchWorkspace::local(0);
+        NodeId s = positionOf[source];
+        ws.startQuery(nodeCount());
+        ws.reach(s, 0, kNoNode);
+        ws.heap.push(0, s);
+        while (!ws.heap.empty()) {
+            auto top = ws.heap.pop();
+            if (top.first == ws.distance(top.second)) {
+                ++ws.settledNodes;
+                relaxUpward(ws, top.second, top.first, true, limit);
+            }
+        }
+
+        nodes.clear();
+        for (NodeId p = 0; p < nodeCount(); ++p) {
+            Seconds best = ws.distance(p);
+            for (std::uint32_t e = firstUp[p]; e < firstUp[p + 1]; ++e) {
+                const UpEdge& edge = upEdges[e];
+                Seconds d = ws.distance(edge.target);
+                if (!edge.forward && d != kUnreachable && d + edge.weight < best) {
+                    best = d + edge.weight;
+                }
+            }
+            if (best <= limit) {
+                if (best != ws.distance(p)) {
+                    ws.reach(p, best, kNoNode);
+                }
+                nodes.push_back(nodeAt[p]);
+            }
+        }
+    }
+
+    std::size_t memoryBytes() const {
+        return upEdges.size() * sizeof(UpEdge) + (firstUp.size() + positionOf.size() + nodeAt.size()) * sizeof(NodeId);
+    }
+
+private:
+    struct DynamicEdge {
+        NodeId other;
+        Seconds weight;
+        NodeId middle;  // Contracted node a shortcut bypasses (original id)
+    };
+
+    struct UpEdge {
+        NodeId target;  // Higher-ranked endpoint
+        Seconds weight;
+        NodeId middle;
+        bool forward;   // true: lower -> target, false: target -> lower
+    };
+
+    static void addEdge(std::vector<std::vector<DynamicEdge>>& out, std::vector<std::vector<DynamicEdge>>& in,
+                        NodeId from, NodeId to, Seconds weight, NodeId middle) {
+        for (DynamicEdge& e : out[from]) {
+            if (e.other == to) {
+                if (weight < e.weight) {
+                    e.weight = weight;
+                    e.middle = middle;
+                    for (DynamicEdge& back : in[to]) {
+                        if (back.other == from) {
+                            back.weight = weight;
+                            back.middle = middle;
+                        }
+                    }
+                }
+                return;
+            }
+        }
+        out[from].push_back({to, weight, middle});
+        in[to].push_back({from, weight, middle});
+    }
+
+    // Adds (or with `apply` false, only counts) the shortcuts needed to contract v.
+    // The dynamic lists only ever hold edges between uncontracted nodes.
+    static std::size_t contractNode(std::vector<std::vector<DynamicEdge>>& out, std::vector<std::vector<DynamicEdge>>& in,
+                                    NodeId v, bool apply, int settleLimit) {
+        SearchWorkspace& ws = SearchWorkspace::local(0);
+        std::size_t shortcuts = 0;
+        for (std::size_t i = 0; i < in[v].size(); ++i) {
+            DynamicEdge incoming = in[v][i];
+            Seconds maxVia = 0;
+            for (const DynamicEdge& outgoing : out[v]) {
+                if (outgoing.other != incoming.other) {
+                    maxVia = std::max(maxVia, incoming.weight + outgoing.weight);
+                }
+            }
+            if (maxVia == 0) {
+                continue;
+            }
+
+            // Witness search from u that avoids v, bounded in distance and settled nodes
+            ws.startQuery(out.size());
+            ws.reach(incoming.other, 0, kNoNode);
+            ws.heap.push(0, incoming.other);
+            for (int settled = 0; !ws.heap.empty() && settled < settleLimit; ++settled) {
+                auto top = ws.heap.pop();
+                if (top.first != ws.distance(top.second)) {
+                    continue;
+                }
+                if (top.first > maxVia) {
+                    break;
+                }
+                for (const DynamicEdge& e : out[top.second]) {
+                    Seconds d = top.first + e.weight;
+                    if (e.other != v && d < ws.distance(e.other)) {
+                        ws.reach(e.other, d, top.second);
+                        ws.heap.push(d, e.other);
+                    }
+                }
+            }
+
+            for (std::size_t j = 0; j < out[v].size(); ++j) {
+                DynamicEdge outgoing = out[v][j];
+                Seconds via = incoming.weight + outgoing.weight;
+                if (outgoing.other != incoming.other && ws.distance(outgoing.other) > via) {
+                    ++shortcuts;
+                    if (apply) {
+                        addEdge(out, in, incoming.other, outgoing.other, via, v);
+                    }
+                }
+            }
+        }
+        return shortcuts;
+    }
+
+    static void eraseEdgesTo(std::vector<DynamicEdge>& edges, NodeId v) {
+        edges.erase(std::remove_if(edges.begin(), edges.end(), [v](const DynamicEdge& e) { return e.other == v; }),
+                    edges.end());
+    }
+
+    // Greedy node ordering by edge difference with lazy priority updates. Returns
+    // nodes by ascending rank and moves every hierarchy edge into `edges`.
+    static std::vector<NodeId> contract(std::vector<std::vector<DynamicEdge>>& out, std::vector<std::vector<DynamicEdge>>& in,
+                                        std::vector<std::pair<NodeId, DynamicEdge>>& edges) {
+        std::size_t n = out.size();
+        std::vector<bool> contracted(n, false);
+        std::vector<int> deletedNeighbours(n, 0);
+        auto priority = [&](NodeId v) {
+            int removed = static_cast<int>(out[v].size() + in[v].size());
+            return 2 * static_cast<int>(contractNode(out, in, v, false, 50)) - removed + deletedNeighbours[v];
+        };
+
+        using Entry = std::pair<int, NodeId>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        for (NodeId v = 0; v < n; ++v) {
+            queue.push({priority(v), v});
+        }
+        std::vector<NodeId> order;
+        order.reserve(n);
+        while (!queue.empty()) {
+            NodeId v = queue.top().second;
+            queue.pop();
+            if (contracted[v]) {
+                continue;
+            }
+            int current = priority(v);
+            if (!queue.empty() && current > queue.top().first) {
+                queue.push({current, v});
+                continue;
+            }
+            contractNode(out, in, v, true, 500);
+            contracted[v] = true;
+            order.push_back(v);
+            for (const DynamicEdge& e : out[v]) {
+                ++deletedNeighbours[e.other];
+                eraseEdgesTo(in[e.other], v);
+                edges.push_back({v, e});
+            }
+            for (const DynamicEdge& e : in[v]) {
+                ++deletedNeighbours[e.other];
+                eraseEdgesTo(out[e.other], v);
+                edges.push_back({e.other, {v, e.weight, e.middle}});
+            }
+            std::vector<DynamicEdge>().swap(out[v]);
+            std::vector<DynamicEdge>().swap(in[v]);
+        }
+        return order;
+    }
+
+    void relaxUpward(SearchWorkspace& ws, NodeId v, Seconds base, bool forward, Seconds limit) const {
+        for (std::uint32_t e = firstUp[v]; e < firstUp[v + 1]; ++e) {
+            const UpEdge& edge = upEdges[e];
+            if (edge.forward != forward) {
+                continue;
+            }
+            Seconds d = base + edge.weight;
+            if (d <= limit && d < ws.distance(edge.target)) {
+                ws.reach(edge.target, d, v);
+                ws.heap.push(d, edge.target);
+            }
+        }
+    }
+
+    // Lightest stored edge between positions `lower` and `higher` in the given direction
+    const UpEdge& findEdge(NodeId lower, NodeId higher, bool forward) const {
+        const UpEdge* best = nullptr;
+        for (std::uint32_t e = firstUp[lower]; e < firstUp[lower + 1]; ++e) {
+            const UpEdge& edge = upEdges[e];
+            if (edge.target == higher && edge.forward == forward && (!best || edge.weight < best->weight)) {
+                best = &edge;
+            }
+        }
+        return *best;
+    }
+
+    // Appends the original nodes of hierarchy edge from -> to, excluding `from`,
+    // and optionally the weight of each original arc
+    void unpack(NodeId from, NodeId to, std::vector<NodeId>& nodes, std::vector<Seconds>* legs) const {
+        const UpEdge& edge = from > to ? findEdge(from, to, true) : findEdge(to, from, false);
+        if (edge.middle == kNoNode) {
+            nodes.push_back(nodeAt[to]);
+            if (legs) {
+                legs->push_back(edge.weight);
+            }
+            return;
+        }
+        unpack(from, edge.middle, nodes, legs);
+        unpack(edge.middle, to, nodes, legs);
+    }
+
+    // Original-node path through `meeting`: forward search tree down to it, backward tree up from it
+    void extractPath(SearchWorkspace& fwd, const SearchWorkspace& bwd, NodeId meeting,
+                     std::vector<NodeId>& nodes, std::vector<Seconds>* legs) const {
+        fwd.path.clear();
+        for (NodeId v = meeting; v != kNoNode; v = fwd.parent(v)) {
+            fwd.path.push_back({v, 0});
+        }
+        std::reverse(fwd.path.begin(), fwd.path.end());
+        for (NodeId v = bwd.parent(meeting); v != kNoNode; v = bwd.parent(v)) {
+            fwd.path.push_back({v, 0});
+        }
+        nodes.push_back(nodeAt[fwd.path[0].first]);
+        for (std::size_t i = 1; i < fwd.path.size(); ++i) {
+            unpack(fwd.path[i - 1].first, fwd.path[i].first, nodes, legs);
+        }
     }
+
+    std::vector<NodeId> positionOf;
+    std::vector<NodeId> nodeAt;
+    std::vector<std::uint32_t> firstUp;
+    std::vector<UpEdge> upEdges;
 };
 
+inline Seconds walkingSeconds(const RoadGraph::Arc& arc) {
+    return travelSeconds(arc.lengthMeters, 5);
+}
+
+inline Seconds cyclingSeconds(const RoadGraph::Arc& arc) {
+    return travelSeconds(arc.lengthMeters, std::min<std::uint32_t>(arc.speedKmh, 15));
+}
+
 // Concrete Strategy - Walking
 class WalkingStrategy : public RouteStrategy {
 public:
-    void buildRoute(const std::string& start, const std::string& end) override {
-        std::cout << "Calculating walking route from " << start << " to " << end << std::endl;
+    explicit WalkingStrategy(std::shared_ptr<const RoadGraph> graph)
+        : graph(std::move(graph)), hierarchy(*this->graph, Walking, walkingSeconds) {}
+
+    const char* name() const override { return "walking"; }
+    TravelMode mode() const override { return Walking; }
+
+    bool buildRoute(NodeId start, NodeId end, Route& route) const override {
+        return hierarchy.query(start, end, route);
     }
+
+    void alternativeRoutes(NodeId start, NodeId end, const AlternativeOptions& options,
+                           std::vector<Route>& routes) const override {
+        hierarchy.alternatives(start, end, options, routes);
+    }
+
+    void reachableWithin(NodeId source, Seconds limit, std::vector<NodeId>& nodes) const override {
+        hierarchy.reachable(source, limit, nodes);
+    }
+
+    std::size_t memoryBytes() const override { return hierarchy.memoryBytes(); }
+
+private:
+    const std::shared_ptr<const RoadGraph> graph;
+    const ContractionHierarchy hierarchy;
 };
 
 // Concrete Strategy - Cycling
 class CyclingStrategy : public RouteStrategy {
 public:
-    void buildRoute(const std::string& start, const std::string& end) override {
-        std::cout << "Calculating cycling route from " << start << " to " << end << std::endl;
+    explicit CyclingStrategy(std::shared_ptr<const RoadGraph> graph)
+        : graph(std::move(graph)), hierarchy(*this->graph, Cycling, cyclingSeconds) {}
+
+    const char* name() const override { return "cycling"; }
+    TravelMode mode() const override { return Cycling; }
+
+    bool buildRoute(NodeId start, NodeId end, Route& route) const override {
+        return hierarchy.query(start, end, route);
+    }
+
+    void alternativeRoutes(NodeId start, NodeId end, const AlternativeOptions& options,
+                           std::vector<Route>& routes) const override {
+        hierarchy.alternatives(start, end, options, routes);
+    }
+
+    void reachableWithin(NodeId source, Seconds limit, std::vector<NodeId>& nodes) const override {
+        hierarchy.reachable(source, limit, nodes);
+    }
+
+    std::size_t memoryBytes() const override { return hierarchy.memoryBytes(); }
+
+private:
+    const std::shared_ptr<const RoadGraph> graph;
+    const ContractionHierarchy hierarchy;
+};
+
+// Public transport timetable. Text format, one record per line:
+//   stop <stopId> <graphNodeName>
+//   trip <line> <stopId> <HH:MM> <stopId> <HH:MM> ...
+// Trips of a line that visit the same stop sequence form one RAPTOR route.
+class Timetable {
+public:
+    struct Line {
+        std::string name;
+        std::vector<std::uint32_t> stops;
+        std::vector<Seconds> times;  // trips x stops, trips sorted by departure
+        std::size_t tripCount() const { return stops.empty() ? 0 : times.size() / stops.size(); }
+        Seconds time(std::size_t trip, std::size_t index) const { return times[trip * stops.size() + index]; }
+    };
+
+    static Timetable load(const RoadGraph& graph, std::istream& in) {
+        Timetable timetable;
+        std::unordered_map<std::string, std::uint32_t> stopIds;
+        std::map<std::pair<std::string, std::vector<std::uint32_t>>, std::vector<std::vector<Seconds>>> trips;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string kind;
+            if (!(fields >> kind) || kind[0] == '#') {
+                continue;
+            }
+            if (kind == "stop") {
+                std::string id, node;
+                fields >> id >> node;
+                stopIds[id] = static_cast<std::uint32_t>(timetable.stopNodes.size());
+                timetable.stopNodes.push_back(graph.nodeId(node));
+                timetable.stopNames.push_back(id);
+            } else if (kind == "trip") {
+                std::string name, stop, clock;
+                fields >> name;
+                std::vector<std::uint32_t> sequence;
+                std::vector<Seconds> times;
+                while (fields >> stop >> clock) {
+                    auto it = stopIds.find(stop);
+                    if (it == stopIds.end()) {
+                        throw std::runtime_error("Timetable references unknown stop " + stop);
+                    }
+                    sequence.push_back(it->second);
+                    times.push_back(parseClock(clock));
+                }
+                trips[{name, sequence}].push_back(times);
+            } else {
+                throw std::runtime_error("Unknown timetable record: " + kind);
+            }
+        }
+
+        timetable.linesAtStop.resize(timetable.stopNodes.size());
+        for (auto& entry : trips) {
+            Line route{entry.first.first, entry.first.second, {}};
+            std::sort(entry.second.begin(), entry.second.end());
+            for (const auto& times : entry.second) {
+                route.times.insert(route.times.end(), times.begin(), times.end());
+            }
+            for (std::uint32_t i = 0; i < route.stops.size(); ++i) {
+                timetable.linesAtStop[route.stops[i]].push_back({static_cast<std::uint32_t>(timetable.lines.size()), i});
+            }
+            timetable.lines.push_back(std::move(route));
+        }
+        return timetable;
+    }
+
+    static Timetable loadFile(const RoadGraph& graph, const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open timetable " + path);
+        }
+        return load(graph, in);
+    }
+
+    static Seconds parseClock(const std::string& clock) {
+        unsigned hours = 0, minutes = 0, seconds = 0;
+        if (std::sscanf(clock.c_str(), "%u:%u:%u", &hours, &minutes, &seconds) < 2) {
+            throw std::runtime_error("Bad time in timetable: " + clock);
+        }
+        return hours * 3600 + minutes * 60 + seconds;
+    }
+
+    std::size_t stopCount() const { return stopNodes.size(); }
+
+    std::vector<NodeId> stopNodes;
+    std::vector<std::string> stopNames;
+    std::vector<Line> lines;
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> linesAtStop;  // (line, index in line)
+};
+
+// One leg of a multimodal journey
+struct JourneyLeg {
+    const char* mode;  // "walk", "bike" or "transit"
+    std::string line;  // Transit line name
+    NodeId from;
+    NodeId to;
+    Seconds departure;
+    Seconds arrival;
+};
+
+struct Journey {
+    std::vector<JourneyLeg> legs;
+    Route route;
+};
+
+// Concrete Strategy - Multimodal
+// Walking and bike-share riding form a two-layer graph (node v walking, node
+// v + n riding) joined by pick-up/drop-off edges at stations. Transit is
+// handled by RAPTOR rounds seeded from, and finished by, layered searches.
+class MultimodalStrategy : public RouteStrategy {
+public:
+    MultimodalStrategy(std::shared_ptr<const RoadGraph> graph, const std::vector<NodeId>& bikeStations,
+                       Timetable timetable, Seconds defaultDeparture = 8 * 3600)
+        : graph(std::move(graph)), isStation(this->graph->nodeCount(), false),
+          timetable(std::move(timetable)), defaultDeparture(defaultDeparture) {
+        for (NodeId v : bikeStations) {
+            isStation[v] = true;
+        }
+
+        // Walking transfers between nearby stops, computed once
+        SearchWorkspace& ws = SearchWorkspace::local(0);
+        transfers.resize(this->timetable.stopCount());
+        std::unordered_map<NodeId, std::vector<std::uint32_t>> stopsAtNode;
+        for (std::uint32_t p = 0; p < this->timetable.stopCount(); ++p) {
+            stopsAtNode[this->timetable.stopNodes[p]].push_back(p);
+        }
+        for (std::uint32_t p = 0; p < this->timetable.stopCount(); ++p) {
+            layeredSearch(ws, this->timetable.stopNodes[p], false, kMaxTransfer, false);
+            for (const auto& entry : stopsAtNode) {
+                Seconds walk = ws.distance(entry.first);
+                for (std::uint32_t q : entry.second) {
+                    if (q != p && walk != kUnreachable) {
+                        transfers[p].push_back({q, walk});
+                    }
+                }
+            }
+        }
+    }
+
+    const char* name() const override { return "multimodal"; }
+    TravelMode mode() const override { return Walking; }
+
+    bool buildRoute(NodeId start, NodeId end, Route& route) const override {
+        Journey journey;
+        bool found = planJourney(start, end, defaultDeparture, journey);
+        route = std::move(journey.route);
+        return found;
+    }
+
+    // Multimodal trips have a single best plan per departure time
+    void alternativeRoutes(NodeId start, NodeId end, const AlternativeOptions&,
+                           std::vector<Route>& routes) const override {
+        routes.resize(1);
+        if (!buildRoute(start, end, routes[0])) {
+            routes.clear();
+        }
+    }
+
+    // Walking and bike share only; transit reach depends on the departure time
+    void reachableWithin(NodeId source, Seconds limit, std::vector<NodeId>& nodes) const override {
+        SearchWorkspace& ws = SearchWorkspace::local(0);
+        layeredSearch(ws, source, false, limit, true);
+        nodes.clear();
+        for (NodeId v = 0; v < graph->nodeCount(); ++v) {
+            if (ws.distance(v) != kUnreachable) {
+                nodes.push_back(v);
+            }
+        }
+    }
+
+    std::size_t memoryBytes() const override {
+        std::size_t bytes = isStation.size() / 8 + timetable.stopCount() * sizeof(NodeId);
+        for (const auto& line : timetable.lines) {
+            bytes += line.stops.size() * sizeof(std::uint32_t) + line.times.size() * sizeof(Seconds);
+        }
+        for (const auto& list : transfers) {
+            bytes += list.size() * sizeof(list[0]);
+        }
+        return bytes;
     }
+
+    // Earliest arrival leaving `start` at `departure` (seconds after midnight)
+    bool planJourney(NodeId start, NodeId end, Seconds departure, Journey& journey) const {
+        std::size_t stops = timetable.stopCount();
+        SearchWorkspace& access = SearchWorkspace::local(0);
+        SearchWorkspace& egress = SearchWorkspace::local(1);
+        layeredSearch(access, start, false, kMaxAccess, true, end, kMaxDirect);
+        layeredSearch(egress, end, true, kMaxAccess, true);
+
+        // Round 0: reach stops on foot or by bike; also the no-transit option
+        Seconds bestArrival = access.distance(end) == kUnreachable ? kUnreachable : departure + access.distance(end);
+        std::vector<std::vector<Label>> rounds(1, std::vector<Label>(stops));
+        std::vector<Seconds> earliest(stops, kUnreachable);
+        std::vector<bool> marked(stops, false);
+        for (std::uint32_t p = 0; p < stops; ++p) {
+            Seconds d = access.distance(timetable.stopNodes[p]);
+            if (d != kUnreachable) {
+                rounds[0][p] = {departure + d, Label::Access, 0, 0, 0, 0};
+                earliest[p] = departure + d;
+                marked[p] = true;
+            }
+        }
+        std::uint32_t bestStop = kNoNode;
+        std::size_t bestRound = 0;
+
+        for (std::size_t k = 1; k <= kMaxRides; ++k) {
+            std::vector<Label> next = rounds.back();
+            for (Label& label : next) {
+                label.kind = label.kind == Label::None ? Label::None : Label::Carried;
+            }
+
+            // Each line is scanned once, from its earliest marked stop
+            std::vector<std::uint32_t> firstMarked(timetable.lines.size(), kNoNode);
+            for (std::uint32_t p = 0; p < stops; ++p) {
+                if (!marked[p]) {
+                    continue;
+                }
+                for (const auto& entry : timetable.linesAtStop[p]) {
+                    firstMarked[entry.first] = std::min(firstMarked[entry.first], entry.second);
+                }
+                marked[p] = false;
+            }
+            bool improved = false;
+            for (std::uint32_t r = 0; r < timetable.lines.size(); ++r) {
+                if (firstMarked[r] == kNoNode) {
+                    continue;
+                }
+                const Timetable::Line& line = timetable.lines[r];
+                std::size_t trip = line.tripCount();
+                std::uint32_t boarded = 0;
+                for (std::uint32_t i = firstMarked[r]; i < line.stops.size(); ++i) {
+                    std::uint32_t p = line.stops[i];
+                    if (trip < line.tripCount()) {
+                        Seconds arrival = line.time(trip, i);
+                        if (arrival < std::min(earliest[p], bestArrival)) {
+                            next[p] = {arrival, Label::Ride, boarded, r, static_cast<std::uint32_t>(trip), i};
+                            earliest[p] = arrival;
+                            marked[p] = true;
+                            improved = true;
+                        }
+                    }
+                    // Catch an earlier trip if we could be here before it leaves
+                    Seconds ready = rounds.back()[p].arrival;
+                    if (ready != kUnreachable && (trip == line.tripCount() || ready <= line.time(trip, i))) {
+                        std::size_t candidate = 0;
+                        while (candidate < line.tripCount() && line.time(candidate, i) < ready) {
+                            ++candidate;
+                        }
+                        if (candidate < trip) {
+                            trip = candidate;
+                            boarded = p;
+                        }
+                    }
+                }
+            }
+
+            // Footpaths between stops
+            for (std::uint32_t p = 0; p < stops; ++p) {
+                if (!marked[p] || next[p].kind != Label::Ride) {
+                    continue;
+                }
+                for (const auto& transfer : transfers[p]) {
+                    Seconds arrival = next[p].arrival + transfer.second;
+                    if (arrival < std::min(earliest[transfer.first], bestArrival)) {
+                        next[transfer.first] = {arrival, Label::Transfer, p, 0, 0, 0};
+                        earliest[transfer.first] = arrival;
+                        marked[transfer.first] = true;
+                    }
+                }
+            }
+            rounds.push_back(std::move(next));
+
+            for (std::uint32_t p = 0; p < stops; ++p) {
+                Seconds walk = egress.distance(timetable.stopNodes[p]);
+                if (marked[p] && walk != kUnreachable && rounds[k][p].arrival + walk < bestArrival) {
+                    bestArrival = rounds[k][p].arrival + walk;
+                    bestStop = p;
+                    bestRound = k;
+                }
+            }
+            if (!improved) {
+                break;
+            }
+        }
+
+        journey.legs.clear();
+        journey.route.nodes.clear();
+        journey.route.travelTime = bestArrival == kUnreachable ? kUnreachable : bestArrival - departure;
+        if (bestArrival == kUnreachable) {
+            return false;
+        }
+        if (bestStop == kNoNode) {
+            appendLayeredLegs(access, start, end, departure, false, journey);
+            return true;
+        }
+
+        // Walk the labels back from the final stop, then emit legs in travel order
+        std::vector<std::pair<std::size_t, std::uint32_t>> chain;
+        std::uint32_t p = bestStop;
+        for (std::size_t k = bestRound;;) {
+            const Label& label = rounds[k][p];
+            if (label.kind == Label::Carried) {
+                --k;
+                continue;
+            }
+            chain.push_back({k, p});
+            if (label.kind == Label::Access) {
+                break;
+            }
+            p = label.from;
+            if (label.kind == Label::Ride) {
+                --k;
+            }
+        }
+        std::reverse(chain.begin(), chain.end());
+
+        std::uint32_t first = chain.front().second;
+        appendLayeredLegs(access, start, timetable.stopNodes[first], departure, false, journey);
+        for (std::size_t i = 1; i < chain.size(); ++i) {
+            const Label& label = rounds[chain[i].first][chain[i].second];
+            NodeId to = timetable.stopNodes[chain[i].second];
+            if (label.kind == Label::Ride) {
+                const Timetable::Line& line = timetable.lines[label.line];
+                std::uint32_t boardIndex = 0;
+                while (line.stops[boardIndex] != label.from) {
+                    ++boardIndex;
+                }
+                journey.legs.push_back({"transit", line.name, timetable.stopNodes[label.from], to,
+                                        line.time(label.trip, boardIndex), label.arrival});
+                for (std::uint32_t j = boardIndex + 1; j <= label.index; ++j) {
+                    journey.route.nodes.push_back(timetable.stopNodes[line.stops[j]]);
+                }
+            } else {
+                Seconds leave = rounds[chain[i - 1].first][label.from].arrival;
+                journey.legs.push_back({"walk", "", timetable.stopNodes[label.from], to, leave, label.arrival});
+                journey.route.nodes.push_back(to);
+            }
+        }
+        appendLayeredLegs(egress, timetable.stopNodes[bestStop], end, rounds[bestRound][bestStop].arrival, true, journey);
+        return true;
+    }
+
+private:
+    // RAPTOR label of a stop in one round
+    struct Label {
+        enum Kind : std::uint8_t { None, Access, Ride, Transfer, Carried };
+        Seconds arrival = kUnreachable;
+        Kind kind = None;
+        std::uint32_t from = 0;   // Boarding stop (Ride) or origin stop (Transfer)
+        std::uint32_t line = 0;
+        std::uint32_t trip = 0;
+        std::uint32_t index = 0;  // Alighting position in the line
+    };
+
+    static const Seconds kMaxAccess = 30 * 60;
+    static const Seconds kMaxDirect = 2 * 3600;
+    static const Seconds kMaxTransfer = 5 * 60;
+    static const std::size_t kMaxRides = 4;
+    static const Seconds kPickUp = 60;
+    static const Seconds kDropOff = 30;
+
+    // Dijkstra over the walk/bike layers, bounded by `limit`. A backward
+    // search follows arcs in reverse and finds times *to* the origin. With a
+    // target, the search keeps going up to `targetLimit` until it is settled.
+    void layeredSearch(SearchWorkspace& ws, NodeId origin, bool backward, Seconds limit, bool allowBikes,
+                       NodeId target = kNoNode, Seconds targetLimit = 0) const {
+        NodeId n = static_cast<NodeId>(graph->nodeCount());
+        ws.startQuery(2 * static_cast<std::size_t>(n));
+        ws.reach(origin, 0, kNoNode);
+        ws.heap.push(0, origin);
+        Seconds bound = target == kNoNode ? limit : std::max(limit, targetLimit);
+        while (!ws.heap.empty()) {
+            auto top = ws.heap.pop();
+            NodeId state = top.second;
+            if (top.first != ws.distance(state)) {
+                continue;
+            }
+            if (top.first > bound) {
+                break;
+            }
+            if (state == target) {
+                bound = std::max(limit, top.first);
+            }
+            ++ws.settledNodes;
+            bool riding = state >= n;
+            NodeId v = riding ? state - n : state;
+            auto relax = [&](NodeId to, Seconds weight) {
+                Seconds d = top.first + weight;
+                if (d <= bound && d < ws.distance(to)) {
+                    ws.reach(to, d, state);
+                    ws.heap.push(d, to);
+                }
+            };
+            if (allowBikes && isStation[v]) {
+                // Forward: walk -> ride is a pick-up; backward the roles swap
+                relax(riding ? v : v + n, riding != backward ? kDropOff : kPickUp);
+            }
+            std::uint8_t layerMode = riding ? Cycling : Walking;
+            std::uint32_t end = backward ? graph->endInArc(v) : graph->endArc(v);
+            for (std::uint32_t i = backward ? graph->firstInArc(v) : graph->firstArc(v); i < end; ++i) {
+                std::uint32_t a = backward ? graph->inArc(i) : i;
+                const RoadGraph::Arc& arc = graph->arc(a);
+                if (arc.modes & layerMode) {
+                    NodeId w = backward ? graph->tail(a) : arc.head;
+                    relax(riding ? w + n : w, riding ? cyclingSeconds(arc) : walkingSeconds(arc));
+                }
+            }
+        }
+    }
+
+    // Appends walk/bike legs between two nodes from a finished layered search.
+    // Forward searches hold parents toward `from`, backward ones toward `to`.
+    void appendLayeredLegs(const SearchWorkspace& ws, NodeId from, NodeId to, Seconds leave, bool backward,
+                           Journey& journey) const {
+        NodeId n = static_cast<NodeId>(graph->nodeCount());
+        std::vector<NodeId> states;
+        for (NodeId state = backward ? from : to; state != kNoNode; state = ws.parent(state)) {
+            states.push_back(state);
+        }
+        if (!backward) {
+            std::reverse(states.begin(), states.end());
+        }
+        Seconds origin = ws.distance(states.front());
+        std::size_t legStart = 0;
+        for (std::size_t i = 0; i < states.size(); ++i) {
+            NodeId v = states[i] % n;
+            if (journey.route.nodes.empty() || journey.route.nodes.back() != v) {
+                journey.route.nodes.push_back(v);
+            }
+            bool lastOfLeg = i + 1 == states.size() || (states[i + 1] >= n) != (states[i] >= n);
+            if (lastOfLeg && i > legStart) {
+                Seconds depart = backward ? origin - ws.distance(states[legStart]) : ws.distance(states[legStart]) - origin;
+                Seconds arrive = backward ? origin - ws.distance(states[i]) : ws.distance(states[i]) - origin;
+                journey.legs.push_back({states[i] >= n ? "bike" : "walk", "", states[legStart] % n, v,
+                                        leave + depart, leave + arrive});
+            }
+            if (lastOfLeg) {
+                legStart = i + 1;
+            }
+        }
+    }
+
+    const std::shared_ptr<const RoadGraph> graph;
+    std::vector<bool> isStation;
+    const Timetable timetable;
+    std::vector<std::vector<std::pair<std::uint32_t, Seconds>>> transfers;
+    const Seconds defaultDeparture;
 };
 
-// Context Class
+// Packed uniform grid over the nodes usable by one travel mode, for snapping
+// coordinates to the nearest routable node. Positions are projected to
+// meters around the network's centre; entries are stored contiguously by cell.
+class NodeLocator {
+public:
+    NodeLocator(const RoadGraph& graph, std::uint8_t mode) {
+        std::vector<bool> routable(graph.nodeCount(), false);
+        for (NodeId v = 0; v < graph.nodeCount(); ++v) {
+            for (std::uint32_t a = graph.firstArc(v); a < graph.endArc(v); ++a) {
+                if (graph.arc(a).modes & mode) {
+                    routable[v] = true;
+                    routable[graph.arc(a).head] = true;
+                }
+            }
+        }
+
+        double minLat = 90, maxLat = -90, minLon = 180, maxLon = -180;
+        std::size_t count = 0;
+        for (NodeId v = 0; v < graph.nodeCount(); ++v) {
+            if (routable[v]) {
+                Coordinate c = graph.location(v);
+                minLat = std::min(minLat, c.lat);
+                maxLat = std::max(maxLat, c.lat);
+                minLon = std::min(minLon, c.lon);
+                maxLon = std::max(maxLon, c.lon);
+                ++count;
+            }
+        }
+        if (count == 0) {
+            return;
+        }
+        originLat = minLat;
+        originLon = minLon;
+        metersPerDegreeLon = kMetersPerDegree * std::cos((minLat + maxLat) / 2 * kPi / 180);
+
+        // Aim for about two nodes per cell
+        double width = std::max(1.0, (maxLon - minLon) * metersPerDegreeLon);
+        double height = std::max(1.0, (maxLat - minLat) * kMetersPerDegree);
+        cellSize = std::max(1.0, std::sqrt(width * height / std::max<std::size_t>(1, count / 2)));
+        columns = static_cast<std::uint32_t>(width / cellSize) + 1;
+        rows = static_cast<std::uint32_t>(height / cellSize) + 1;
+
+        std::vector<Entry> unsorted;
+        unsorted.reserve(count);
+        for (NodeId v = 0; v < graph.nodeCount(); ++v) {
+            if (routable[v]) {
+                double x, y;
+                project(graph.location(v), x, y);
+                unsorted.push_back({static_cast<float>(x), static_cast<float>(y), v});
+            }
+        }
+        cellStart.assign(static_cast<std::size_t>(columns) * rows + 1, 0);
+        for (const Entry& e : unsorted) {
+            ++cellStart[cellIndex(e.x, e.y) + 1];
+        }
+        for (std::size_t c = 1; c < cellStart.size(); ++c) {
+            cellStart[c] += cellStart[c - 1];
+        }
+        entries.resize(count);
+        std::vector<std::uint32_t> next(cellStart.begin(), cellStart.end() - 1);
+        for (const Entry& e : unsorted) {
+            entries[next[cellIndex(e.x, e.y)]++] = e;
+        }
+    }
+
+    // Nearest routable node by straight-line distance, or kNoNode if the mode has no roads
+    NodeId snap(Coordinate point) const {
+        if (entries.empty()) {
+            return kNoNode;
+        }
+        double x, y;
+        project(point, x, y);
+        std::int64_t cx = clampCell(x, columns), cy = clampCell(y, rows);
+
+        NodeId best = kNoNode;
+        double bestSquared = std::numeric_limits<double>::max();
+        std::int64_t maxRing = std::max(columns, rows);
+        for (std::int64_t ring = 0; ring <= maxRing; ++ring) {
+            for (std::int64_t gy = cy - ring; gy <= cy + ring; ++gy) {
+                if (gy < 0 || gy >= rows) {
+                    continue;
+                }
+                // Interior rows of the ring only contribute their two edge cells
+                std::int64_t step = (gy == cy - ring || gy == cy + ring) ? 1 : std::max<std::int64_t>(1, 2 * ring);
+                for (std::int64_t gx = cx - ring; gx <= cx + ring; gx += step) {
+                    if (gx < 0 || gx >= columns) {
+                        continue;
+                    }
+                    std::size_t cell = static_cast<std::size_t>(gy) * columns + gx;
+                    for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                        double dx = entries[i].x - x, dy = entries[i].y - y;
+                        double squared = dx * dx + dy * dy;
+                        if (squared < bestSquared) {
+                            bestSquared = squared;
+                            best = entries[i].node;
+                        }
+                    }
+                }
+            }
+            // Cells in the next ring are at least `ring` cells away
+            double reach = ring * cellSize;
+            if (best != kNoNode && bestSquared <= reach * reach) {
+                break;
+            }
+        }
+        return best;
+    }
+
+    // Snaps a batch of points, visiting them in grid order so neighbouring
+    // queries touch the same cells back to back
+    void snapAll(const std::vector<Coordinate>& points, std::vector<NodeId>& nodes) const {
+        std::vector<std::pair<std::size_t, std::uint32_t>> order(points.size());
+        for (std::uint32_t i = 0; i < points.size(); ++i) {
+            double x, y;
+            project(points[i], x, y);
+            order[i] = {static_cast<std::size_t>(clampCell(y, rows)) * columns + clampCell(x, columns), i};
+        }
+        std::sort(order.begin(), order.end());
+        nodes.resize(points.size());
+        for (const auto& entry : order) {
+            nodes[entry.second] = snap(points[entry.second]);
+        }
+    }
+
+    std::size_t memoryBytes() const {
+        return entries.size() * sizeof(Entry) + cellStart.size() * sizeof(std::uint32_t);
+    }
+
+private:
+    struct Entry {
+        float x;
+        float y;
+        NodeId node;
+    };
+
+    static constexpr double kMetersPerDegree = 111320.0;
+    static constexpr double kPi = 3.14159265358979323846;
+
+    void project(Coordinate c, double& x, double& y) const {
+        x = (c.lon - originLon) * metersPerDegreeLon;
+        y = (c.lat - originLat) * kMetersPerDegree;
+    }
+
+    std::int64_t clampCell(double meters, std::uint32_t cells) const {
+        return std::min<std::int64_t>(cells - 1, std::max<std::int64_t>(0, static_cast<std::int64_t>(meters / cellSize)));
+    }
+
+    std::size_t cellIndex(float x, float y) const {
+        return static_cast<std::size_t>(clampCell(y, rows)) * columns + clampCell(x, columns);
+    }
+
+    double originLat = 0;
+    double originLon = 0;
+    double metersPerDegreeLon = kMetersPerDegree;
+    double cellSize = 1;
+    std::uint32_t columns = 0;
+    std::uint32_t rows = 0;
+    std::vector<std::uint32_t> cellStart;
+    std::vector<Entry> entries;
+};
+
+// Context Class - safe to share between threads; setStrategy swaps the strategy atomically
 class Navigator {
 private:
-    RouteStrategy* strategy;
+    std::shared_ptr<const RoadGraph> graph;
+    std::shared_ptr<const RouteStrategy> strategy;
+    const NodeLocator drivingLocator;
+    const NodeLocator walkingLocator;
+    const NodeLocator cyclingLocator;
 
 public:
-    void setStrategy(RouteStrategy* newStrategy) {
-        strategy = newStrategy;
+    explicit Navigator(std::shared_ptr<const RoadGraph> graph)
+        : graph(std::move(graph)),
+          drivingLocator(*this->graph, Driving),
+          walkingLocator(*this->graph, Walking),
+          cyclingLocator(*this->graph, Cycling) {}
+
+    const NodeLocator& locator(TravelMode mode) const {
+        return mode == Driving ? drivingLocator : mode == Walking ? walkingLocator : cyclingLocator;
     }
 
-    void navigate(const std::string& start, const std::string& end) {
-        if (strategy) {
-            strategy->buildRoute(start, end);
-        } else {
+    void setStrategy(std::shared_ptr<const RouteStrategy> newStrategy) {
+        std::atomic_store(&strategy, std::move(newStrategy));
+    }
+
+    bool navigate(NodeId start, NodeId end, Route& route) const {
+        std::shared_ptr<const RouteStrategy> current = std::atomic_load(&strategy);
+        return current && current->buildRoute(start, end, route);
+    }
+
+    // Snaps both endpoints to the nearest node the current strategy can use
+    bool navigate(Coordinate start, Coordinate end, Route& route) const {
+        std::shared_ptr<const RouteStrategy> current = std::atomic_load(&strategy);
+        if (!current) {
+            return false;
+        }
+        const NodeLocator& nodes = locator(current->mode());
+        NodeId from = nodes.snap(start), to = nodes.snap(end);
+        return from != kNoNode && to != kNoNode && current->buildRoute(from, to, route);
+    }
+
+    void navigate(const std::string& start, const std::string& end) const {
+        std::shared_ptr<const RouteStrategy> current = std::atomic_load(&strategy);
+        if (!current) {
             std::cout << "No strategy set!" << std::endl;
+            return;
         }
+
+        std::cout << "Calculating " << current->name() << " route from " << start << " to " << end << std::endl;
+        Route route;
+        if (!current->buildRoute(graph->nodeId(start), graph->nodeId(end), route)) {
+            std::cout << "  No " << current->name() << " route found" << std::endl;
+            return;
+        }
+        std::cout << " ";
+        for (std::size_t i = 0; i < route.nodes.size(); ++i) {
+            std::cout << (i ? " -> " : " ") << graph->nodeName(route.nodes[i]);
+        }
+        std::cout << " (" << route.travelTime / 60 << " min)" << std::endl;
+    }
+
+    void showAlternatives(const std::string& start, const std::string& end) const {
+        std::shared_ptr<const RouteStrategy> current = std::atomic_load(&strategy);
+        if (!current) {
+            std::cout << "No strategy set!" << std::endl;
+            return;
+        }
+        std::vector<Route> routes;
+        current->alternativeRoutes(graph->nodeId(start), graph->nodeId(end), AlternativeOptions(), routes);
+        std::cout << "Alternative " << current->name() << " routes from " << start << " to " << end << ":" << std::endl;
+        for (const Route& route : routes) {
+            std::cout << " ";
+            for (std::size_t i = 0; i < route.nodes.size(); ++i) {
+                std::cout << (i ? " -> " : " ") << graph->nodeName(route.nodes[i]);
+            }
+            std::cout << " (" << route.travelTime / 60 << " min)" << std::endl;
+        }
+    }
+
+    void showReachable(const std::string& start, Seconds minutes) const {
+        std::shared_ptr<const RouteStrategy> current = std::atomic_load(&strategy);
+        if (!current) {
+            std::cout << "No strategy set!" << std::endl;
+            return;
+        }
+        std::vector<NodeId> nodes;
+        current->reachableWithin(graph->nodeId(start), minutes * 60, nodes);
+        std::cout << "Reachable from " << start << " within " << minutes << " min by " << current->name() << ":";
+        for (NodeId v : nodes) {
+            std::cout << " " << graph->nodeName(v);
+        }
+        std::cout << std::endl;
     }
 };
 
+// Benchmark Harness - run with: strategy_pattern --bench [gridSide] [queries]
+// Builds a synthetic city grid with arterials and one-way streets, then times
+// every strategy on uniform and locality-biased query sets.
+std::shared_ptr<RoadGraph> makeGridGraph(std::uint32_t side, std::uint32_t seed) {
+    auto graph = std::make_shared<RoadGraph>();
+    std::mt19937 rng(seed);
+    for (std::uint32_t r = 0; r < side; ++r) {
+        for (std::uint32_t c = 0; c < side; ++c) {
+            graph->addNode(std::to_string(r) + "," + std::to_string(c), {52.0 + r * 0.001, 13.0 + c * 0.0015});
+        }
+    }
+    auto addStreet = [&](NodeId a, NodeId b, bool arterial) {
+        std::uint32_t length = 80 + rng() % 170;
+        if (arterial) {
+            graph->addRoad(a, b, length, 70, Driving | Cycling);
+        } else if (rng() % 20 == 0) {
+            graph->addRoad(a, b, length, 30, AllModes, false);  // One-way for cars only
+            graph->addRoad(b, a, length, 30, Walking | Cycling, false);
+        } else {
+            graph->addRoad(a, b, length, static_cast<std::uint16_t>(30 + rng() % 20), AllModes);
+        }
+    };
+    for (std::uint32_t r = 0; r < side; ++r) {
+        for (std::uint32_t c = 0; c < side; ++c) {
+            NodeId v = r * side + c;
+            if (c + 1 < side) {
+                addStreet(v, v + 1, r % 10 == 0);
+            }
+            if (r + 1 < side) {
+                addStreet(v, v + side, c % 10 == 0);
+            }
+        }
+    }
+    graph->finalize();
+    return graph;
+}
+
+// Uniform pairs when radius is 0, otherwise targets within `radius` blocks of the source
+std::vector<std::pair<NodeId, NodeId>> makeQueries(std::uint32_t side, std::size_t count, std::uint32_t radius,
+                                                   std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::pair<NodeId, NodeId>> queries(count);
+    for (auto& query : queries) {
+        std::uint32_t r = rng() % side, c = rng() % side;
+        std::uint32_t tr = rng() % side, tc = rng() % side;
+        if (radius > 0) {
+            std::int64_t dr = static_cast<std::int64_t>(rng() % (2 * radius + 1)) - radius;
+            std::int64_t dc = static_cast<std::int64_t>(rng() % (2 * radius + 1)) - radius;
+            tr = static_cast<std::uint32_t>(std::min<std::int64_t>(side - 1, std::max<std::int64_t>(0, r + dr)));
+            tc = static_cast<std::uint32_t>(std::min<std::int64_t>(side - 1, std::max<std::int64_t>(0, c + dc)));
+        }
+        query = {r * side + c, tr * side + tc};
+    }
+    return queries;
+}
+
+// Bus lines alternating between rows and columns, 10 stops each, a trip every
+// 10 minutes from 06:00 to 10:00 at one minute per block
+std::string makeTimetable(std::uint32_t side, std::uint32_t lineCount, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::ostringstream out;
+    const std::uint32_t stopsPerLine = 10, spacing = std::max<std::uint32_t>(1, side / stopsPerLine);
+    for (std::uint32_t l = 0; l < lineCount; ++l) {
+        std::uint32_t fixed = rng() % side;
+        std::vector<std::string> stops;
+        for (std::uint32_t i = 0; i < stopsPerLine && i * spacing < side; ++i) {
+            std::uint32_t along = i * spacing;
+            std::string node = l % 2 == 0 ? std::to_string(fixed) + "," + std::to_string(along)
+                                          : std::to_string(along) + "," + std::to_string(fixed);
+            stops.push_back("L" + std::to_string(l) + "S" + std::to_string(i));
+            out << "stop " << stops.back() << " " << node << "\n";
+        }
+        for (Seconds start = 6 * 3600 + rng() % 600; start < 10 * 3600; start += 600) {
+            out << "trip Line" << l;
+            for (std::size_t i = 0; i < stops.size(); ++i) {
+                Seconds t = start + static_cast<Seconds>(i * spacing * 60);
+                char clock[16];
+                std::snprintf(clock, sizeof(clock), "%02u:%02u", t / 3600, t / 60 % 60);
+                out << " " << stops[i] << " " << clock;
+            }
+            out << "\n";
+        }
+    }
+    return out.str();
+}
+
+void benchmarkStrategy(const RouteStrategy& strategy, const char* set,
+                       const std::vector<std::pair<NodeId, NodeId>>& queries) {
+    using Clock = std::chrono::steady_clock;
+    Route route;
+    for (std::size_t i = 0; i < std::min<std::size_t>(100, queries.size()); ++i) {
+        strategy.buildRoute(queries[i].first, queries[i].second, route);  // Warm up the workspace
+    }
+
+    std::uint64_t settledBefore = SearchWorkspace::local(0).settledNodes + SearchWorkspace::local(1).settledNodes;
+    std::vector<double> latencies(queries.size());
+    Clock::time_point begin = Clock::now();
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        Clock::time_point start = Clock::now();
+        strategy.buildRoute(queries[i].first, queries[i].second, route);
+        latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::uint64_t settled = SearchWorkspace::local(0).settledNodes + SearchWorkspace::local(1).settledNodes - settledBefore;
+
+    // Throughput with every core issuing queries against the same strategy
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> pool;
+    begin = Clock::now();
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            Route local;
+            for (std::size_t i = t; i < queries.size(); i += threads) {
+                strategy.buildRoute(queries[i].first, queries[i].second, local);
+            }
+        });
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    double parallelSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-8s %-8s %10.0f %10.0f %9.1f %9.1f %10.0f %9.1f\n", strategy.name(), set,
+                queries.size() / seconds, queries.size() / parallelSeconds,
+                latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100],
+                static_cast<double>(settled) / queries.size(), strategy.memoryBytes() / 1048576.0);
+}
+
+// Parses a positive decimal count no larger than limit; returns 0 for anything else
+std::size_t parseCount(const char* text, std::size_t limit) {
+    if (!std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return 0;  // stoull would skip spaces and accept a wrapping minus sign
+    }
+    try {
+        std::size_t used = 0;
+        unsigned long long value = std::stoull(text, &used);
+        return text[used] == '\0' && value <= limit ? static_cast<std::size_t>(value) : 0;
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+// side * side nodes must stay below kNoNode
+const std::size_t kMaxBenchSide = 65535;
+const std::size_t kMaxBenchQueries = 100000000;
+
+int runBenchmark(std::uint32_t side, std::size_t queryCount) {
+    using Clock = std::chrono::steady_clock;
+    std::printf("Grid %ux%u, %zu queries per set\n", side, side, queryCount);
+    std::shared_ptr<const RoadGraph> graph = makeGridGraph(side, 42);
+
+    std::vector<std::shared_ptr<const RouteStrategy>> strategies;
+    for (int i = 0; i < 3; ++i) {
+        Clock::time_point start = Clock::now();
+        if (i == 0) {
+            strategies.push_back(std::make_shared<DrivingStrategy>(graph));
+        } else if (i == 1) {
+            strategies.push_back(std::make_shared<WalkingStrategy>(graph));
+        } else {
+            strategies.push_back(std::make_shared<CyclingStrategy>(graph));
+        }
+        std::printf("Preprocessed %s in %.0f ms\n", strategies.back()->name(),
+                    std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+
+    // The overlay is only useful if every level really splits the graph into bounded cells
+    const OverlayPartition& overlay = static_cast<const DrivingStrategy&>(*strategies[0]).overlay();
+    for (std::size_t l = 1; l <= overlay.levelCount(); ++l) {
+        std::printf("Overlay level %zu: %zu cells, largest %u nodes (limit %u)\n", l, overlay.cellCount(l),
+                    overlay.largestCell(l), overlay.maxCellNodes(l));
+        if (overlay.largestCell(l) > overlay.maxCellNodes(l)) {
+            std::fprintf(stderr, "Overlay level %zu has a cell above its size limit\n", l);
+            return 1;
+        }
+    }
+
+    auto uniform = makeQueries(side, queryCount, 0, 7);
+    auto local = makeQueries(side, queryCount, std::max<std::uint32_t>(2, side / 20), 11);
+    std::printf("%-8s %-8s %10s %10s %9s %9s %10s %9s\n", "strategy", "set", "q/s", "q/s(all)",
+                "p50(us)", "p99(us)", "settled", "mem(MB)");
+    for (const auto& strategy : strategies) {
+        benchmarkStrategy(*strategy, "uniform", uniform);
+        benchmarkStrategy(*strategy, "local", local);
+    }
+
+    std::vector<NodeId> nodes;
+    for (const auto& strategy : strategies) {
+        Clock::time_point start = Clock::now();
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < 100; ++i) {
+            strategy->reachableWithin(uniform[i % uniform.size()].first, 15 * 60, nodes);
+            total += nodes.size();
+        }
+        std::printf("%-8s isochrone(15 min) %8.2f ms avg, %zu nodes avg\n", strategy->name(),
+                    std::chrono::duration<double, std::milli>(Clock::now() - start).count() / 100, total / 100);
+    }
+
+    std::vector<Route> routes;
+    for (const auto& strategy : strategies) {
+        Clock::time_point start = Clock::now();
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < 100; ++i) {
+            strategy->alternativeRoutes(uniform[i % uniform.size()].first, uniform[i % uniform.size()].second,
+                                        AlternativeOptions(), routes);
+            total += routes.size();
+        }
+        std::printf("%-8s alternatives       %8.2f ms avg, %.2f routes avg\n", strategy->name(),
+                    std::chrono::duration<double, std::milli>(Clock::now() - start).count() / 100, total / 100.0);
+    }
+
+    // Multimodal: bike stations every 10 blocks, 40 bus lines, journeys leaving at 08:00
+    std::vector<NodeId> bikeStations;
+    for (std::uint32_t r = 0; r < side; r += 10) {
+        for (std::uint32_t c = 0; c < side; c += 10) {
+            bikeStations.push_back(r * side + c);
+        }
+    }
+    std::istringstream schedule(makeTimetable(side, 40, 13));
+    Timetable timetable = Timetable::load(*graph, schedule);
+    std::size_t stops = timetable.stopCount();
+    Clock::time_point start = Clock::now();
+    MultimodalStrategy multimodal(graph, bikeStations, std::move(timetable));
+    std::printf("Preprocessed multimodal (%zu stops, %zu bike stations) in %.0f ms\n", stops,
+                bikeStations.size(), std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    std::size_t journeys = std::min<std::size_t>(1000, uniform.size());
+    std::vector<double> latencies(journeys);
+    Journey journey;
+    for (std::size_t i = 0; i < journeys; ++i) {
+        start = Clock::now();
+        multimodal.planJourney(uniform[i].first, uniform[i].second, 8 * 3600, journey);
+        latencies[i] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("multimodal journeys   p50 %.2f ms, p99 %.2f ms over %zu queries\n", latencies[journeys / 2],
+                latencies[journeys * 99 / 100], journeys);
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("Peak resident memory: %.1f MB\n", usage.ru_maxrss / 1024.0);
+    return 0;
+}
+
 // Client Code
-int main() {
-    Navigator navigator;
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        std::size_t side = argc > 2 ? parseCount(argv[2], kMaxBenchSide) : 200;
+        std::size_t queries = argc > 3 ? parseCount(argv[3], kMaxBenchQueries) : 10000;
+        if (side == 0 || queries == 0) {  // makeQueries draws modulo side and the percentiles need a sample
+            std::fprintf(stderr, "Usage: --bench [side 1-%zu] [queries 1-%zu]\n", kMaxBenchSide, kMaxBenchQueries);
+            return 1;
+        }
+        return runBenchmark(static_cast<std::uint32_t>(side), queries);
+    }
 
-    DrivingStrategy drive;
-    WalkingStrategy walk;
-    CyclingStrategy cycle;
+    auto graph = std::make_shared<RoadGraph>();
+    graph->addNode("Home", {52.5200, 13.4050});
+    graph->addNode("Highway", {52.5350, 13.4200});
+    graph->addNode("Office", {52.5600, 13.5200});
+    graph->addNode("Park", {52.5250, 13.4200});
+    graph->addNode("Riverside", {52.5450, 13.4500});
+    graph->addRoad("Home", "Highway", 2000, 50, Driving);
+    graph->addRoad("Highway", "Office", 8000, 100, Driving);
+    graph->addRoad("Home", "Park", 1200, 30, AllModes);
+    graph->addRoad("Park", "Riverside", 2500, 30, Walking | Cycling);
+    graph->addRoad("Riverside", "Office", 1500, 30, AllModes);
+    graph->addRoad("Park", "Office", 6000, 40, Driving | Cycling);
+    graph->finalize();
+
+    Navigator navigator(graph);
+
+    auto drive = std::make_shared<DrivingStrategy>(graph);
+    auto walk = std::make_shared<WalkingStrategy>(graph);
+    auto cycle = std::make_shared<CyclingStrategy>(graph);
 
     std::string start = "Home";
     std::string end = "Office";
 
-    navigator.setStrategy(&drive);
+    navigator.setStrategy(drive);
     navigator.navigate(start, end);  // Driving route
 
-    navigator.setStrategy(&walk);
+    navigator.setStrategy(walk);
     navigator.navigate(start, end);  // Walking route
 
-    navigator.setStrategy(&cycle);
+    navigator.setStrategy(cycle);
     navigator.navigate(start, end);  // Cycling route
 
+    // Give drivers a choice of routes
+    navigator.setStrategy(drive);
+    navigator.showAlternatives(start, end);
+
+    // A traffic jam on the highway re-customizes the driving overlay
+    NodeId home = graph->nodeId("Home");
+    NodeId highway = graph->nodeId("Highway");
+    std::size_t cells = drive->applyTrafficUpdates({{home, highway, 5}, {highway, home, 5}});
+    std::cout << "Traffic update re-customized " << cells << " cells" << std::endl;
+    navigator.setStrategy(drive);
+    navigator.navigate(start, end);  // Driving route avoiding the jam
+
+    // Isochrone: everything within 15 minutes by bike
+    navigator.setStrategy(cycle);
+    navigator.showReachable(start, 15);
+
+    // Walk -> bike share -> walk, or take the bus, whichever arrives first
+    std::istringstream schedule(
+        "stop P Park\n"
+        "stop R Riverside\n"
+        "stop O Office\n"
+        "trip Bus42 P 08:05 R 08:10 O 08:15\n"
+        "trip Bus42 P 08:20 R 08:25 O 08:30\n"
+        "trip Bus42 P 08:35 R 08:40 O 08:45\n");
+    MultimodalStrategy multimodal(graph, {graph->nodeId("Park"), graph->nodeId("Office")},
+                                  Timetable::load(*graph, schedule));
+    auto clock = [](Seconds t) {
+        char text[16];
+        std::snprintf(text, sizeof(text), "%02u:%02u", t / 3600, t / 60 % 60);
+        return std::string(text);
+    };
+    for (Seconds departure : {Timetable::parseClock("08:00"), Timetable::parseClock("08:10")}) {
+        Journey journey;
+        if (multimodal.planJourney(graph->nodeId(start), graph->nodeId(end), departure, journey)) {
+            std::cout << "Multimodal trip leaving at " << clock(departure) << ":" << std::endl;
+            for (const JourneyLeg& leg : journey.legs) {
+                std::cout << "  " << clock(leg.departure) << "-" << clock(leg.arrival) << " " << leg.mode
+                          << (leg.line.empty() ? "" : " " + leg.line) << " " << graph->nodeName(leg.from)
+                          << " -> " << graph->nodeName(leg.to) << std::endl;
+            }
+        }
+    }
+
+    // Requests arrive as coordinates and are snapped to the nearest routable node
+    Route snapped;
+    if (navigator.navigate(Coordinate{52.5210, 13.4070}, Coordinate{52.5590, 13.5150}, snapped)) {
+        std::cout << "Cycling from coordinates: " << graph->nodeName(snapped.nodes.front()) << " to "
+                  << graph->nodeName(snapped.nodes.back()) << " (" << snapped.travelTime / 60 << " min)" << std::endl;
+    }
+    std::vector<NodeId> pickups;
+    navigator.locator(Walking).snapAll({{52.5440, 13.4510}, {52.5260, 13.4190}, {52.5360, 13.4210}}, pickups);
+    std::cout << "Walking pickups snapped to:";
+    for (NodeId v : pickups) {
+        std::cout << " " << graph->nodeName(v);
+    }
+    std::cout << std::endl;
+
+    // Request threads share one navigator; each reuses its own search workspace
+    std::vector<std::thread> workers;
+    std::vector<Seconds> times(4);
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        workers.emplace_back([&, i] {
+            Route route;
+            for (int q = 0; q < 1000; ++q) {
+                navigator.navigate(graph->nodeId(start), graph->nodeId(end), route);
+            }
+            times[i] = route.travelTime;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::cout << "Concurrent queries finished: " << times[0] / 60 << " min" << std::endl;
+
     return 0;
 }